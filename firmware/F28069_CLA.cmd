@@ -0,0 +1,144 @@
+/*
+//###########################################################################
+//
+// FILE:    F28069_CLA.cmd
+//
+// TITLE:   Linker Command File For PicoCommander on the F28069 with the CLA
+//
+//          Based on F28069.cmd from controlSUITE f2806x v150.  The
+//          differences are all to give the CLA the memory it needs:
+//
+//          - RAML3 is CLA program memory, so .ebss moves to RAML4.
+//          - RAML1 and RAML2 are CLA data memory.
+//          - The CPU to CLA message RAMs are defined.
+//
+//          M0 and M1 are also joined into one range for the stack, which
+//          holds the nested timer interrupts of the engine's timed tasks.
+//
+//          Use with F2806x_Headers_nonBIOS.cmd for the peripheral frames.
+//
+//###########################################################################
+*/
+
+MEMORY
+{
+PAGE 0 :   /* Program Memory */
+           /* Memory (RAM/FLASH/OTP) blocks can be moved to PAGE1 for data allocation */
+   RAML0       : origin = 0x008000, length = 0x000800     /* on-chip RAM block L0 */
+   RAML3       : origin = 0x009000, length = 0x001000     /* on-chip RAM block L3, CLA program */
+   OTP         : origin = 0x3D7800, length = 0x000400     /* on-chip OTP */
+
+   FLASHH      : origin = 0x3D8000, length = 0x004000     /* on-chip FLASH, the program store */
+   FLASHG      : origin = 0x3DC000, length = 0x004000     /* on-chip FLASH */
+   FLASHF      : origin = 0x3E0000, length = 0x004000     /* on-chip FLASH */
+   FLASHE      : origin = 0x3E4000, length = 0x004000     /* on-chip FLASH */
+   FLASHD      : origin = 0x3E8000, length = 0x004000     /* on-chip FLASH */
+   FLASHC      : origin = 0x3EC000, length = 0x004000     /* on-chip FLASH */
+   FLASHA      : origin = 0x3F4000, length = 0x003F80     /* on-chip FLASH */
+   CSM_RSVD    : origin = 0x3F7F80, length = 0x000076     /* Part of FLASHA.  Program with all 0x0000 when CSM is in use. */
+   BEGIN       : origin = 0x3F7FF6, length = 0x000002     /* Part of FLASHA.  Used for "boot to Flash" bootloader mode. */
+   CSM_PWL_P0  : origin = 0x3F7FF8, length = 0x000008     /* Part of FLASHA.  CSM password locations in FLASHA */
+
+   FPUTABLES   : origin = 0x3FD860, length = 0x0006A0     /* FPU Tables in Boot ROM */
+   IQTABLES    : origin = 0x3FDF00, length = 0x000B50     /* IQ Math Tables in Boot ROM */
+   IQTABLES2   : origin = 0x3FEA50, length = 0x00008C     /* IQ Math Tables in Boot ROM */
+   IQTABLES3   : origin = 0x3FEADC, length = 0x0000AA     /* IQ Math Tables in Boot ROM */
+
+   ROM         : origin = 0x3FF3B0, length = 0x000C10     /* Boot ROM */
+   RESET       : origin = 0x3FFFC0, length = 0x000002     /* part of boot ROM  */
+   VECTORS     : origin = 0x3FFFC2, length = 0x00003E     /* part of boot ROM  */
+
+PAGE 1 :   /* Data Memory */
+           /* Memory (RAM/FLASH/OTP) blocks can be moved to PAGE0 for program allocation */
+           /* Registers remain on PAGE1                                                  */
+   BOOT_RSVD   : origin = 0x000000, length = 0x000050     /* Part of M0, BOOT rom will use this for stack */
+   RAMM0M1     : origin = 0x000050, length = 0x0007B0     /* on-chip RAM blocks M0 and M1 */
+   CLA1_MSGRAMLOW  : origin = 0x001480, length = 0x000080 /* CLA to CPU message RAM */
+   CLA1_MSGRAMHIGH : origin = 0x001500, length = 0x000080 /* CPU to CLA message RAM */
+   RAML1       : origin = 0x008800, length = 0x000400     /* on-chip RAM block L1, CLA data RAM 0 */
+   RAML2       : origin = 0x008C00, length = 0x000400     /* on-chip RAM block L2, CLA data RAM 1 */
+   RAML4       : origin = 0x00A000, length = 0x002000     /* on-chip RAM block L4 */
+   RAML5       : origin = 0x00C000, length = 0x002000     /* on-chip RAM block L5 */
+   RAML6       : origin = 0x00E000, length = 0x002000     /* on-chip RAM block L6 */
+   RAML7       : origin = 0x010000, length = 0x002000     /* on-chip RAM block L7 */
+   RAML8       : origin = 0x012000, length = 0x002000     /* on-chip RAM block L8 */
+   USB_RAM     : origin = 0x040000, length = 0x000800     /* USB RAM */
+   FLASHB      : origin = 0x3F0000, length = 0x004000     /* on-chip FLASH */
+}
+
+SECTIONS
+{
+   /* Allocate program areas: */
+   .cinit              : > FLASHA,     PAGE = 0
+   .pinit              : > FLASHA,     PAGE = 0
+   .text               : >> FLASHC | FLASHA | FLASHE,  PAGE = 0
+   codestart           : > BEGIN,      PAGE = 0
+   ramfuncs            : LOAD = FLASHD,
+                         RUN = RAML0,
+                         LOAD_START(_RamfuncsLoadStart),
+                         LOAD_END(_RamfuncsLoadEnd),
+                         RUN_START(_RamfuncsRunStart),
+                         LOAD_SIZE(_RamfuncsLoadSize),
+                         PAGE = 0
+
+   csmpasswds          : > CSM_PWL_P0, PAGE = 0
+   csm_rsvd            : > CSM_RSVD,   PAGE = 0
+
+   /* Allocate uninitalized data sections: */
+   .stack              : > RAMM0M1,    PAGE = 1
+   .ebss               : > RAML4,      PAGE = 1
+   .esysmem            : > RAML4,      PAGE = 1
+
+   /* Initalized sections to go in Flash */
+   .econst             : > FLASHA,     PAGE = 0
+   .switch             : > FLASHA,     PAGE = 0
+
+   /* Allocate IQ math areas: */
+   IQmath              : > FLASHA,     PAGE = 0
+   IQmathTables        : > IQTABLES,   PAGE = 0, TYPE = NOLOAD
+
+   /* Allocate FPU math areas: */
+   FPUmathTables       : > FPUTABLES,  PAGE = 0, TYPE = NOLOAD
+
+   DMARAML5            : > RAML5,      PAGE = 1
+   DMARAML6            : > RAML6,      PAGE = 1
+   DMARAML7            : > RAML7,      PAGE = 1
+   DMARAML8            : > RAML8,      PAGE = 1
+
+   /* CLA program, copied to RAML3 by ClaInit() */
+   Cla1Prog            : LOAD = FLASHD,
+                         RUN = RAML3,
+                         LOAD_START(_Cla1funcsLoadStart),
+                         LOAD_SIZE(_Cla1funcsLoadSize),
+                         RUN_START(_Cla1funcsRunStart),
+                         PAGE = 0
+
+   /* CLA message RAMs */
+   Cla1ToCpuMsgRAM     : > CLA1_MSGRAMLOW,   PAGE = 1
+   CpuToCla1MsgRAM     : > CLA1_MSGRAMHIGH,  PAGE = 1
+
+   /* CLA C compiler sections.  The scratchpad holds CLA locals and must be
+      in CLA data RAM. */
+   CLAscratch          :
+                         { *.obj(CLAscratch)
+                         . += 0x100;
+                         *.obj(CLAscratch_end) } > RAML1,  PAGE = 1
+
+   .scratchpad         : > RAML1,      PAGE = 1
+   .bss_cla            : > RAML2,      PAGE = 1
+   .const_cla          : LOAD = FLASHB,
+                         RUN = RAML2,
+                         LOAD_START(_Cla1ConstLoadStart),
+                         LOAD_SIZE(_Cla1ConstLoadSize),
+                         RUN_START(_Cla1ConstRunStart),
+                         PAGE = 1
+
+   .reset              : > RESET,      PAGE = 0, TYPE = DSECT
+   vectors             : > VECTORS,    PAGE = 0, TYPE = DSECT
+}
+
+/*
+//===========================================================================
+// End of file.
+//===========================================================================
+*/
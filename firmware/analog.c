@@ -0,0 +1,245 @@
+//###########################################################################
+//
+// FILE:   analog.c
+//
+// TITLE:  Analog inputs sampled by the ADC into a DMA ring.
+//
+// ePWM5 starts a burst of conversions at a fixed rate.  The end of the last
+// conversion raises ADCINT1, which triggers DMA channel 1 to copy the burst
+// of results into the next row of a ring in RAM.  The CPU takes no part in
+// sampling; AnalogRead() finds the newest rows from the DMA's own write
+// pointer and averages them in a fixed number of steps.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "analog.h"
+
+//*****************************************************************************
+//
+// ADC and DMA selections, from the F2806x ADC and DMA reference guides.
+//
+//*****************************************************************************
+#define ADC_TRIGSEL_EPWM5_SOCA      13
+#define ADC_ACQPS_MIN               6
+#define ADC_CHSEL_A1                1
+#define ADC_CHSEL_B1                9
+#define DMA_PERINTSEL_ADCINT1       1
+
+#if (ANALOG_NUM_SOCS > 16)
+#error "The ADC has only 16 SOCs"
+#endif
+
+#if (ANALOG_RING_ROWS & (ANALOG_RING_ROWS - 1)) ||                            \
+    (ANALOG_RING_ROWS <= ANALOG_AVERAGE)
+#error "ANALOG_RING_ROWS must be a power of two above ANALOG_AVERAGE"
+#endif
+
+//*****************************************************************************
+//
+// The ADC channel of each analog input.
+//
+//*****************************************************************************
+static const uint16_t g_pui16Channels[ANALOG_NUM_CHANNELS] =
+{
+    ADC_CHSEL_A1,
+    ADC_CHSEL_B1
+};
+
+//*****************************************************************************
+//
+// The sample ring, written only by the DMA.  SOC n converts input
+// n % ANALOG_NUM_CHANNELS, so the channels are sampled interleaved.  L5 is
+// one of the RAM blocks the DMA can reach.
+//
+//*****************************************************************************
+#pragma DATA_SECTION(g_pui16AnalogRing, "DMARAML5");
+static volatile uint16_t g_pui16AnalogRing[ANALOG_RING_ROWS][ANALOG_NUM_SOCS];
+
+//*****************************************************************************
+//
+// Power up and calibrate the ADC and assign its SOCs to the channels.
+//
+//*****************************************************************************
+static void
+AnalogADCInit(void)
+{
+    volatile union ADCSOCxCTL_REG *psSOC;
+    uint16_t ui16SOC;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.ADCENCLK = 1;
+    (*Device_cal)();
+
+    AdcRegs.ADCCTL1.bit.ADCREFSEL = 0;
+    AdcRegs.ADCCTL1.bit.ADCBGPWD = 1;
+    AdcRegs.ADCCTL1.bit.ADCREFPWD = 1;
+    AdcRegs.ADCCTL1.bit.ADCPWDN = 1;
+    AdcRegs.ADCCTL1.bit.ADCENABLE = 1;
+    EDIS;
+
+    DELAY_US(1000);
+
+    EALLOW;
+
+    //
+    // Raise ADCINT1 once the last result is latched, and keep raising it
+    // without the flag being cleared since only the DMA listens.
+    //
+    AdcRegs.ADCCTL1.bit.INTPULSEPOS = 1;
+    AdcRegs.INTSEL1N2.bit.INT1SEL = ANALOG_NUM_SOCS - 1;
+    AdcRegs.INTSEL1N2.bit.INT1CONT = 1;
+    AdcRegs.INTSEL1N2.bit.INT1E = 1;
+
+    psSOC = &AdcRegs.ADCSOC0CTL;
+    for(ui16SOC = 0; ui16SOC < ANALOG_NUM_SOCS; ui16SOC++)
+    {
+        psSOC[ui16SOC].bit.CHSEL =
+            g_pui16Channels[ui16SOC % ANALOG_NUM_CHANNELS];
+        psSOC[ui16SOC].bit.ACQPS = ADC_ACQPS_MIN;
+        psSOC[ui16SOC].bit.TRIGSEL = ADC_TRIGSEL_EPWM5_SOCA;
+    }
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Run DMA channel 1 as a ring: each ADCINT1 copies one burst of
+// ANALOG_NUM_SOCS results to the next row, and the channel restarts at the
+// first row after the last.
+//
+//*****************************************************************************
+static void
+AnalogDMAInit(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.DMAENCLK = 1;
+
+    DmaRegs.DMACTRL.bit.HARDRESET = 1;
+    __asm(" NOP");
+    DmaRegs.DEBUGCTRL.bit.FREE = 1;
+
+    //
+    // The source wraps back to ADCRESULT0 after every burst.
+    //
+    DmaRegs.CH1.SRC_BEG_ADDR_SHADOW = (uint32_t)&AdcResult.ADCRESULT0;
+    DmaRegs.CH1.SRC_ADDR_SHADOW = (uint32_t)&AdcResult.ADCRESULT0;
+    DmaRegs.CH1.DST_BEG_ADDR_SHADOW = (uint32_t)g_pui16AnalogRing;
+    DmaRegs.CH1.DST_ADDR_SHADOW = (uint32_t)g_pui16AnalogRing;
+
+    DmaRegs.CH1.BURST_SIZE.all = ANALOG_NUM_SOCS - 1;
+    DmaRegs.CH1.SRC_BURST_STEP = 1;
+    DmaRegs.CH1.DST_BURST_STEP = 1;
+
+    DmaRegs.CH1.TRANSFER_SIZE = ANALOG_RING_ROWS - 1;
+    DmaRegs.CH1.SRC_TRANSFER_STEP = 0;
+    DmaRegs.CH1.DST_TRANSFER_STEP = 1;
+
+    DmaRegs.CH1.SRC_WRAP_SIZE = 0;
+    DmaRegs.CH1.SRC_WRAP_STEP = 0;
+    DmaRegs.CH1.DST_WRAP_SIZE = 0xFFFF;
+    DmaRegs.CH1.DST_WRAP_STEP = 0;
+
+    DmaRegs.CH1.MODE.bit.PERINTSEL = DMA_PERINTSEL_ADCINT1;
+    DmaRegs.CH1.MODE.bit.PERINTE = 1;
+    DmaRegs.CH1.MODE.bit.CONTINUOUS = 1;
+    DmaRegs.CH1.MODE.bit.ONESHOT = 0;
+    DmaRegs.CH1.MODE.bit.DATASIZE = 0;
+    DmaRegs.CH1.MODE.bit.CHINTE = 0;
+
+    DmaRegs.CH1.CONTROL.bit.PERINTCLR = 1;
+    DmaRegs.CH1.CONTROL.bit.ERRCLR = 1;
+    DmaRegs.CH1.CONTROL.bit.RUN = 1;
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Start ePWM5 counting up from 0 to its period, with a start of conversion
+// at every zero.
+//
+//*****************************************************************************
+static void
+AnalogTriggerInit(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR1.bit.EPWM5ENCLK = 1;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 0;
+    EDIS;
+
+    EPwm5Regs.TBCTL.bit.CTRMODE = TB_FREEZE;
+    EPwm5Regs.TBCTL.bit.HSPCLKDIV = TB_DIV1;
+    EPwm5Regs.TBCTL.bit.CLKDIV = TB_DIV1;
+    EPwm5Regs.TBPRD = (SysCtlClockGet(SYSTEM_CLOCK_SPEED) /
+                       ANALOG_TRIGGER_HZ) - 1;
+    EPwm5Regs.TBCTR = 0;
+
+    EPwm5Regs.ETSEL.bit.SOCASEL = ET_CTR_ZERO;
+    EPwm5Regs.ETPS.bit.SOCAPRD = ET_1ST;
+    EPwm5Regs.ETSEL.bit.SOCAEN = 1;
+
+    EPwm5Regs.TBCTL.bit.CTRMODE = TB_COUNT_UP;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.TBCLKSYNC = 1;
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Start sampling the analog inputs.  The first readings are valid
+// ANALOG_AVERAGE trigger periods later.
+//
+//*****************************************************************************
+void
+AnalogInit(void)
+{
+    AnalogADCInit();
+    AnalogDMAInit();
+    AnalogTriggerInit();
+}
+
+//*****************************************************************************
+//
+// Return the filtered reading of an analog input, 0 to 4095.
+//
+// The row the DMA is writing is found from its destination address and the
+// ANALOG_AVERAGE complete rows before it are averaged.  The DMA would have
+// to fill the rest of the ring during the read to overtake it.
+//
+//*****************************************************************************
+uint16_t
+AnalogRead(uint16_t ui16Channel)
+{
+    uint32_t ui32Sum;
+    uint16_t ui16Row, ui16Rows, ui16SOC;
+
+    if(ui16Channel >= ANALOG_NUM_CHANNELS)
+    {
+        return(0);
+    }
+
+    ui16Row = (uint16_t)((DmaRegs.CH1.DST_ADDR_ACTIVE -
+                          (uint32_t)g_pui16AnalogRing) / ANALOG_NUM_SOCS);
+
+    ui32Sum = 0;
+    for(ui16Rows = 0; ui16Rows < ANALOG_AVERAGE; ui16Rows++)
+    {
+        ui16Row = (ui16Row - 1) & (ANALOG_RING_ROWS - 1);
+
+        for(ui16SOC = ui16Channel; ui16SOC < ANALOG_NUM_SOCS;
+            ui16SOC += ANALOG_NUM_CHANNELS)
+        {
+            ui32Sum += g_pui16AnalogRing[ui16Row][ui16SOC];
+        }
+    }
+
+    return((uint16_t)(ui32Sum / (ANALOG_AVERAGE * ANALOG_OVERSAMPLE)));
+}
@@ -0,0 +1,43 @@
+//###########################################################################
+//
+// FILE:   analog.h
+//
+// TITLE:  Analog inputs sampled by the ADC into a DMA ring.
+//
+//###########################################################################
+
+#ifndef __ANALOG_H__
+#define __ANALOG_H__
+
+//*****************************************************************************
+//
+// The analog inputs.  Channel 0 is ADCINA1 and channel 1 is ADCINB1; ADCINA0
+// is avoided as it doubles as VREFHI.
+//
+//*****************************************************************************
+#define ANALOG_NUM_CHANNELS         2
+
+//*****************************************************************************
+//
+// Sampling.  ePWM5 triggers all ANALOG_NUM_SOCS conversions, each channel
+// ANALOG_OVERSAMPLE times, ANALOG_TRIGGER_HZ times a second.  A reading is
+// the mean of a channel's conversions over the last ANALOG_AVERAGE triggers.
+//
+//*****************************************************************************
+#define ANALOG_TRIGGER_HZ           4000
+#define ANALOG_OVERSAMPLE           4
+#define ANALOG_NUM_SOCS             (ANALOG_NUM_CHANNELS * ANALOG_OVERSAMPLE)
+#define ANALOG_AVERAGE              4
+
+//*****************************************************************************
+//
+// Rows of ANALOG_NUM_SOCS results in the DMA ring.  This must be a power of
+// two greater than ANALOG_AVERAGE.
+//
+//*****************************************************************************
+#define ANALOG_RING_ROWS            16
+
+extern void AnalogInit(void);
+extern uint16_t AnalogRead(uint16_t ui16Channel);
+
+#endif // __ANALOG_H__
@@ -0,0 +1,231 @@
+//###########################################################################
+//
+// FILE:   capture.c
+//
+// TITLE:  Interrupt driven input edge capture.
+//
+// Selected inputs are routed to the XINT external interrupts so that edges
+// are caught however long the scan takes.  Each interrupt only timestamps
+// the edge and appends it to a ring; the scan drains the ring once per pass
+// in CaptureUpdate().
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "ring.h"
+#include "capture.h"
+
+//*****************************************************************************
+//
+// The inputs routed to XINT1, XINT2 and XINT3.  ui16Bit is the ReadInput()
+// bit of the pin; only GPIO0 to GPIO31 can be selected as an XINT source.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Bit;
+    uint16_t ui16GPIO;
+}
+tCaptureChannel;
+
+static const tCaptureChannel g_psChannels[CAPTURE_NUM_CHANNELS] =
+{
+    { 5, 0 },
+    { 7, 1 },
+    { 0, 12 }
+};
+
+//*****************************************************************************
+//
+// The edges waiting for CaptureUpdate(), written only by the interrupts.
+//
+//*****************************************************************************
+static tCaptureEvent g_psEvents[CAPTURE_BUFFER_SIZE];
+static tRing g_sEventRing = RING_INIT(g_psEvents);
+
+//*****************************************************************************
+//
+// The captured input levels as of the last CaptureUpdate().
+//
+//*****************************************************************************
+static uint16_t g_ui16Levels = 0;
+
+uint16_t g_ui16CaptureRising = 0;
+uint16_t g_ui16CaptureFalling = 0;
+uint32_t g_pui32CaptureTime[8];
+volatile uint16_t g_ui16CaptureOverflows = 0;
+
+//*****************************************************************************
+//
+// Return the current capture timestamp in SYSCLKOUT cycles.  CPU timer 1
+// counts down so the count is inverted to give an increasing time.
+//
+//*****************************************************************************
+uint32_t
+CaptureTimeNow(void)
+{
+    return(~CpuTimer1Regs.TIM.all);
+}
+
+//*****************************************************************************
+//
+// Append an edge to the ring.
+//
+// \param ui16Channel is the XINT that fired.
+// \param ui16Latency is the XINT counter, the cycles since the edge.
+//
+// If the ring is full the edge is dropped and counted.
+//
+//*****************************************************************************
+static void
+CaptureEdge(uint16_t ui16Channel, uint16_t ui16Latency)
+{
+    const tCaptureChannel *psChannel = &g_psChannels[ui16Channel];
+    tCaptureEvent sEvent;
+
+    sEvent.ui32Time = CaptureTimeNow() - ui16Latency;
+    sEvent.ui16Bit = psChannel->ui16Bit;
+    sEvent.ui16Level = (GpioDataRegs.GPADAT.all >> psChannel->ui16GPIO) & 1;
+
+    if(!RingWrite(&g_sEventRing, &sEvent))
+    {
+        g_ui16CaptureOverflows++;
+    }
+}
+
+//*****************************************************************************
+//
+// The external interrupt handlers.
+//
+//*****************************************************************************
+__interrupt void
+CaptureXINT1Handler(void)
+{
+    CaptureEdge(0, XIntruptRegs.XINT1CTR);
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+__interrupt void
+CaptureXINT2Handler(void)
+{
+    CaptureEdge(1, XIntruptRegs.XINT2CTR);
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+}
+
+__interrupt void
+CaptureXINT3Handler(void)
+{
+    CaptureEdge(2, XIntruptRegs.XINT3CTR);
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP12;
+}
+
+//*****************************************************************************
+//
+// Start the capture timestamp and route the captured inputs to XINT1-3,
+// interrupting on both edges.
+//
+//*****************************************************************************
+void
+CaptureInit(void)
+{
+    uint16_t ui16Channel;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.CPUTIMER1ENCLK = 1;
+
+    GpioIntRegs.GPIOXINT1SEL.all = g_psChannels[0].ui16GPIO;
+    GpioIntRegs.GPIOXINT2SEL.all = g_psChannels[1].ui16GPIO;
+    GpioIntRegs.GPIOXINT3SEL.all = g_psChannels[2].ui16GPIO;
+    EDIS;
+
+    //
+    // CPU timer 1 free runs over the full 32 bits.
+    //
+    CpuTimer1Regs.TCR.bit.TSS = 1;
+    CpuTimer1Regs.PRD.all = 0xFFFFFFFF;
+    CpuTimer1Regs.TPR.all = 0;
+    CpuTimer1Regs.TPRH.all = 0;
+    CpuTimer1Regs.TCR.bit.TIE = 0;
+    CpuTimer1Regs.TCR.bit.TRB = 1;
+    CpuTimer1Regs.TCR.bit.TSS = 0;
+
+    for(ui16Channel = 0; ui16Channel < CAPTURE_NUM_CHANNELS; ui16Channel++)
+    {
+        if((GpioDataRegs.GPADAT.all >> g_psChannels[ui16Channel].ui16GPIO) & 1)
+        {
+            g_ui16Levels |= 1 << g_psChannels[ui16Channel].ui16Bit;
+        }
+    }
+
+    XIntruptRegs.XINT1CR.bit.POLARITY = 3;
+    XIntruptRegs.XINT2CR.bit.POLARITY = 3;
+    XIntruptRegs.XINT3CR.bit.POLARITY = 3;
+
+    IntRegister(INT_XINT1, CaptureXINT1Handler);
+    IntRegister(INT_XINT2, CaptureXINT2Handler);
+    IntRegister(INT_XINT3, CaptureXINT3Handler);
+
+    XIntruptRegs.XINT1CR.bit.ENABLE = 1;
+    XIntruptRegs.XINT2CR.bit.ENABLE = 1;
+    XIntruptRegs.XINT3CR.bit.ENABLE = 1;
+
+    IntEnable(INT_XINT1);
+    IntEnable(INT_XINT2);
+    IntEnable(INT_XINT3);
+}
+
+//*****************************************************************************
+//
+// Drain the edge ring into the rising and falling edge masks.  This is called
+// once before each scan.
+//
+// An edge whose level matches the level already known means the pin went
+// through both edges faster than the interrupt could read it, so the pulse is
+// reported in both masks.
+//
+//*****************************************************************************
+void
+CaptureUpdate(void)
+{
+    tCaptureEvent sEvent;
+    uint16_t ui16Mask;
+
+    g_ui16CaptureRising = 0;
+    g_ui16CaptureFalling = 0;
+
+    while(RingRead(&g_sEventRing, &sEvent))
+    {
+        ui16Mask = 1 << sEvent.ui16Bit;
+
+        if(sEvent.ui16Level)
+        {
+            if(g_ui16Levels & ui16Mask)
+            {
+                g_ui16CaptureFalling |= ui16Mask;
+            }
+            g_ui16CaptureRising |= ui16Mask;
+            g_ui16Levels |= ui16Mask;
+        }
+        else
+        {
+            if(!(g_ui16Levels & ui16Mask))
+            {
+                g_ui16CaptureRising |= ui16Mask;
+            }
+            g_ui16CaptureFalling |= ui16Mask;
+            g_ui16Levels &= ~ui16Mask;
+        }
+
+        g_pui32CaptureTime[sEvent.ui16Bit] = sEvent.ui32Time;
+    }
+}
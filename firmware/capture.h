@@ -0,0 +1,57 @@
+//###########################################################################
+//
+// FILE:   capture.h
+//
+// TITLE:  Interrupt driven input edge capture.
+//
+//###########################################################################
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+//*****************************************************************************
+//
+// Size of the edge event buffer.  This must be a power of two.
+//
+//*****************************************************************************
+#define CAPTURE_BUFFER_SIZE         32
+
+//*****************************************************************************
+//
+// The number of input pins routed to an external interrupt.
+//
+//*****************************************************************************
+#define CAPTURE_NUM_CHANNELS        3
+
+//*****************************************************************************
+//
+// An edge seen on a captured input.  ui32Time is in SYSCLKOUT cycles from the
+// free running CPU timer 1 and ui16Level is the pin level read in the
+// interrupt.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Time;
+    uint16_t ui16Bit;
+    uint16_t ui16Level;
+}
+tCaptureEvent;
+
+//*****************************************************************************
+//
+// Results of the last CaptureUpdate().  The masks use the ReadInput() bit
+// numbering and hold every edge seen on a captured input since the previous
+// update, however short the pulse.
+//
+//*****************************************************************************
+extern uint16_t g_ui16CaptureRising;
+extern uint16_t g_ui16CaptureFalling;
+extern uint32_t g_pui32CaptureTime[8];
+extern volatile uint16_t g_ui16CaptureOverflows;
+
+extern void CaptureInit(void);
+extern void CaptureUpdate(void);
+extern uint32_t CaptureTimeNow(void);
+
+#endif // __CAPTURE_H__
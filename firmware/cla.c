@@ -0,0 +1,213 @@
+//###########################################################################
+//
+// FILE:   cla.c
+//
+// TITLE:  Tile offload to the Control Law Accelerator.
+//
+// Tiles whose opcode is flagged OPCODE_FLAG_CLA do not compute anything on
+// the CPU.  During a scan each one stages its inputs as a job in the CPU to
+// CLA message RAM and outputs the result the CLA gave for it last time.
+// When the scan ends the CLA runs all of the jobs at once, in parallel with
+// the rest of the main loop, and has finished long before the next scan
+// starts.  An offloaded tile's output therefore lags its input by one scan,
+// and the scan itself no longer grows with the math load.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "cla.h"
+
+//*****************************************************************************
+//
+// CLA task masks for MIER, MIFR, MIFRC and MIRUN.
+//
+//*****************************************************************************
+#define CLA_TASK1                   0x0001
+#define CLA_TASK8                   0x0080
+
+//*****************************************************************************
+//
+// MPISRCSEL1 with every task's peripheral trigger set to none.  The default
+// of 0 would start task 1 on ADCINT1, which the analog inputs raise for the
+// DMA.
+//
+//*****************************************************************************
+#define CLA_PERINT_NONE_ALL         0x11111111
+
+//*****************************************************************************
+//
+// The message RAMs.
+//
+//*****************************************************************************
+#pragma DATA_SECTION(g_psClaJobs, "CpuToCla1MsgRAM");
+tClaJob g_psClaJobs[CLA_MAX_JOBS];
+
+#pragma DATA_SECTION(g_ui16ClaNumJobs, "CpuToCla1MsgRAM");
+uint16_t g_ui16ClaNumJobs;
+
+#pragma DATA_SECTION(g_pi16ClaResults, "Cla1ToCpuMsgRAM");
+int16_t g_pi16ClaResults[CLA_MAX_JOBS];
+
+//*****************************************************************************
+//
+// The CLA program and constants are stored in flash and run from CLA RAM.
+// These are defined by F28069_CLA.cmd.
+//
+//*****************************************************************************
+extern uint16_t Cla1funcsLoadStart;
+extern uint16_t Cla1funcsLoadSize;
+extern uint16_t Cla1funcsRunStart;
+extern uint16_t Cla1ConstLoadStart;
+extern uint16_t Cla1ConstLoadSize;
+extern uint16_t Cla1ConstRunStart;
+
+//*****************************************************************************
+//
+// Start the given CLA tasks from software.
+//
+//*****************************************************************************
+static void
+ClaForce(uint16_t ui16Tasks)
+{
+    EALLOW;
+    Cla1Regs.MIFRC.all = ui16Tasks;
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Wait until none of the given tasks is pending or running.
+//
+//*****************************************************************************
+static void
+ClaWaitTasks(uint16_t ui16Tasks)
+{
+    while((Cla1Regs.MIFR.all | Cla1Regs.MIRUN.all) & ui16Tasks)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Load the CLA program, hand it RAM blocks L1 to L3 and clear its state.
+// This must run before a program is loaded.
+//
+//*****************************************************************************
+void
+ClaInit(void)
+{
+    //
+    // Copy the program and constants while the CPU still owns the RAM.
+    //
+    memcpy(&Cla1funcsRunStart, &Cla1funcsLoadStart,
+           (size_t)&Cla1funcsLoadSize);
+    memcpy(&Cla1ConstRunStart, &Cla1ConstLoadStart,
+           (size_t)&Cla1ConstLoadSize);
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.CLA1ENCLK = 1;
+
+    //
+    // Task vectors are offsets from the start of CLA program memory.
+    //
+    Cla1Regs.MVECT1 = (uint16_t)((uint32_t)&Cla1Task1 -
+                                 (uint32_t)&Cla1funcsRunStart);
+    Cla1Regs.MVECT8 = (uint16_t)((uint32_t)&Cla1Task8 -
+                                 (uint32_t)&Cla1funcsRunStart);
+
+    //
+    // No peripheral starts a task; the CPU starts them all.
+    //
+    Cla1Regs.MPISRCSEL1.all = CLA_PERINT_NONE_ALL;
+    Cla1Regs.MCTL.bit.IACKE = 1;
+
+    Cla1Regs.MMEMCFG.bit.PROGE = 1;
+    Cla1Regs.MMEMCFG.bit.RAM0E = 1;
+    Cla1Regs.MMEMCFG.bit.RAM1E = 1;
+
+    Cla1Regs.MIER.all = CLA_TASK1 | CLA_TASK8;
+    EDIS;
+
+    ClaReset();
+}
+
+//*****************************************************************************
+//
+// Forget the filter history and results of the previous program.  This is
+// called when a program is loaded.
+//
+//*****************************************************************************
+void
+ClaReset(void)
+{
+    ClaWaitTasks(CLA_TASK1);
+    g_ui16ClaNumJobs = 0;
+
+    ClaForce(CLA_TASK8);
+    ClaWaitTasks(CLA_TASK8);
+}
+
+//*****************************************************************************
+//
+// Wait for the jobs of the previous scan.  Until they are done neither the
+// jobs nor the results may be touched.
+//
+//*****************************************************************************
+void
+ClaWait(void)
+{
+    ClaWaitTasks(CLA_TASK1);
+}
+
+//*****************************************************************************
+//
+// Run the first ui16Jobs jobs staged by this scan.
+//
+//*****************************************************************************
+void
+ClaStart(uint16_t ui16Jobs)
+{
+    if(ui16Jobs)
+    {
+        g_ui16ClaNumJobs = ui16Jobs;
+        ClaForce(CLA_TASK1);
+    }
+}
+
+//*****************************************************************************
+//
+// Stage a tile's inputs as a job: the first input is the value to work on
+// and the rest are the function's parameters.
+//
+// \return Returns the result of the job from the previous scan.
+//
+//*****************************************************************************
+int
+ClaSubmit(int iJob, uint16_t ui16Function, const int *piInputs,
+          uint16_t ui16Count)
+{
+    tClaJob *psJob;
+    uint16_t n;
+
+    if((iJob < 0) || (iJob >= CLA_MAX_JOBS) || (ui16Count == 0))
+    {
+        return(0);
+    }
+
+    psJob = &g_psClaJobs[iJob];
+    psJob->ui16Function = ui16Function;
+    psJob->i16Input = piInputs[0];
+
+    for(n = 0; n < CLA_MAX_PARAMS; n++)
+    {
+        psJob->pi16Params[n] = (n + 1 < ui16Count) ? piInputs[n + 1] : 0;
+    }
+
+    return(g_pi16ClaResults[iJob]);
+}
@@ -0,0 +1,95 @@
+//###########################################################################
+//
+// FILE:   cla.h
+//
+// TITLE:  Tile offload to the Control Law Accelerator.
+//
+// Shared by the C28x code in cla.c and the CLA tasks in cla_tasks.cla.  On
+// the CLA int is 32 bits, so everything shared is declared with explicit
+// widths.
+//
+//###########################################################################
+
+#ifndef __CLA_H__
+#define __CLA_H__
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// The number of CLA tiles a program may use, and the parameters each one
+// passes besides its input.
+//
+//*****************************************************************************
+#define CLA_MAX_JOBS                16
+#define CLA_MAX_PARAMS              4
+
+//*****************************************************************************
+//
+// The CLA keeps the last CLA_HISTORY inputs of each tile for the filters.
+// This must be a power of two.
+//
+//*****************************************************************************
+#define CLA_HISTORY                 16
+#define CLA_FIR_TAPS                4
+
+//*****************************************************************************
+//
+// The functions a job can ask for.
+//
+// CLA_FN_AVERAGE   the mean of the last pi16Params[0] inputs.
+// CLA_FN_FIR       the sum of pi16Params[k] * input[n - k], the parameters
+//                  being Q15 coefficients.
+// CLA_FN_SCALE     input * pi16Params[0] / pi16Params[1] + pi16Params[2].
+//
+// Results are rounded and saturated to 16 bits.
+//
+//*****************************************************************************
+#define CLA_FN_NONE                 0
+#define CLA_FN_AVERAGE              1
+#define CLA_FN_FIR                  2
+#define CLA_FN_SCALE                3
+
+//*****************************************************************************
+//
+// One tile's work for a scan, written by the CPU.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Function;
+    int16_t i16Input;
+    int16_t pi16Params[CLA_MAX_PARAMS];
+}
+tClaJob;
+
+//*****************************************************************************
+//
+// The message RAMs.  The CPU writes the jobs and the CLA the results.
+//
+//*****************************************************************************
+extern tClaJob g_psClaJobs[CLA_MAX_JOBS];
+extern uint16_t g_ui16ClaNumJobs;
+extern int16_t g_pi16ClaResults[CLA_MAX_JOBS];
+
+//*****************************************************************************
+//
+// The CLA tasks.  Task 1 runs the jobs and task 8 clears the filter history
+// and results.
+//
+//*****************************************************************************
+__interrupt void Cla1Task1(void);
+__interrupt void Cla1Task8(void);
+
+#ifndef __TMS320C28XX_CLA__
+
+extern void ClaInit(void);
+extern void ClaReset(void);
+extern void ClaWait(void);
+extern void ClaStart(uint16_t ui16Jobs);
+extern int ClaSubmit(int iJob, uint16_t ui16Function, const int *piInputs,
+                     uint16_t ui16Count);
+
+#endif
+
+#endif // __CLA_H__
@@ -0,0 +1,1254 @@
+//###########################################################################
+//
+// FILE:   engine.c
+//
+// TITLE:  User program execution engine.
+//
+// The uploaded program is compiled once into a list of instructions, each
+// holding a pointer to its opcode table entry and the value table slots of
+// its operands.  A scan then runs the list with no parsing or string
+// compares.
+//
+// The list is split into tasks.  The background task is scanned by the main
+// loop as often as it can be.  Each timed task is released by the 1ms tick
+// every period and run from the tick interrupt itself, with interrupts
+// enabled again so that a later tick can pre-empt it for a task of higher
+// priority.  A timed task therefore starts within a tick of being due
+// however long the background scan or the lower priority tasks take.
+// Tasks exchange values through the value table, each seeing the other
+// tasks' outputs as of their last run.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "opcodes.h"
+#include "engine.h"
+#include "cla.h"
+#include "pwm.h"
+#include "pulse.h"
+
+//*****************************************************************************
+//
+// A compiled tile call.
+//
+//*****************************************************************************
+typedef struct
+{
+    const tOpcode *psOpcode;
+
+    //
+    // The value table slot the tile's output is written to.
+    //
+    uint16_t ui16Output;
+
+    //
+    // The tile's operands are g_pui16Operands[ui16First] onwards.
+    //
+    uint16_t ui16First;
+    uint16_t ui16Count;
+
+    //
+    // The first value table slot of the tile's state.
+    //
+    uint16_t ui16State;
+}
+tInstruction;
+
+//*****************************************************************************
+//
+// A task, a run of the instruction list scanned at its own rate.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The task's instructions are g_psInstructions[ui16First] onwards.
+    //
+    uint16_t ui16First;
+    uint16_t ui16Count;
+
+    //
+    // Milliseconds between runs, 0 for the background task, and the priority
+    // against the other timed tasks, higher first.
+    //
+    uint16_t ui16Period;
+    uint16_t ui16Priority;
+
+    //
+    // Ticks until the task is next due, and the tick it last started on.
+    //
+    uint16_t ui16Countdown;
+    uint32_t ui32LastRun;
+
+    //
+    // Set when the task falls due, and while it runs.
+    //
+    volatile tBoolean bReady;
+    volatile tBoolean bRunning;
+}
+tTask;
+
+//*****************************************************************************
+//
+// The operands of the instruction being run.  A task pre-empted part way
+// through an instruction keeps its operands here rather than on the stack,
+// so that nested tasks do not need a larger stack.
+//
+//*****************************************************************************
+typedef struct
+{
+    tValue psInputs[ENGINE_MAX_INPUTS];
+    int piInputs[ENGINE_MAX_INPUTS];
+}
+tOperands;
+
+//*****************************************************************************
+//
+// ui16Output of an instruction whose "o" has not been parsed yet, and a task
+// index for no task.
+//
+//*****************************************************************************
+#define ENGINE_NO_OUTPUT            0xFFFF
+#define ENGINE_NO_TASK              0xFFFF
+
+//*****************************************************************************
+//
+// The compiled program.  The tables are too big for .ebss alongside the USB
+// buffers, so they are given RAM block L6 to themselves.
+//
+//*****************************************************************************
+#pragma DATA_SECTION(g_psInstructions, "DMARAML6");
+static tInstruction g_psInstructions[ENGINE_MAX_INSTRUCTIONS];
+static uint16_t g_ui16NumInstructions = 0;
+
+#pragma DATA_SECTION(g_pui16Operands, "DMARAML6");
+static uint16_t g_pui16Operands[ENGINE_MAX_OPERANDS];
+static uint16_t g_ui16NumOperands = 0;
+
+#pragma DATA_SECTION(g_psValues, "DMARAML6");
+static tValue g_psValues[ENGINE_MAX_VALUES];
+static uint16_t g_ui16NumConstants = 0;
+static uint16_t g_ui16NumStates = 0;
+static uint16_t g_ui16NumClaJobs = 0;
+
+static tTask g_psTasks[ENGINE_MAX_TASKS];
+static uint16_t g_ui16NumTasks = 0;
+
+#pragma DATA_SECTION(g_psOperands, "DMARAML6");
+static tOperands g_psOperands[ENGINE_MAX_TASKS];
+
+//*****************************************************************************
+//
+// The timed tasks by priority, highest first, and the background task.
+//
+//*****************************************************************************
+static uint16_t g_pui16TaskOrder[ENGINE_MAX_TASKS];
+static uint16_t g_ui16NumTimed = 0;
+static uint16_t g_ui16Background = ENGINE_NO_TASK;
+
+//*****************************************************************************
+//
+// Whether the timed tasks are being released, and one more than the
+// priority of the timed task running, or 0 when only the background task
+// is.
+//
+//*****************************************************************************
+static volatile tBoolean g_bTasksRunning = false;
+static volatile uint16_t g_ui16TaskLevel = 0;
+
+//*****************************************************************************
+//
+// Milliseconds since boot, and at the start of the last scan.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32Ticks = 0;
+static uint32_t g_ui32LastScan = 0;
+uint16_t g_ui16ScanElapsed = 0;
+
+//*****************************************************************************
+//
+// Look up an opcode by its FunctionReference code.  The table is sorted by
+// code so this is a binary search; it is only used while loading.
+//
+//*****************************************************************************
+const tOpcode *
+OpcodeFind(uint16_t ui16Code)
+{
+    uint16_t ui16Low, ui16High, ui16Mid;
+
+    ui16Low = 0;
+    ui16High = g_ui16NumOpcodes;
+
+    while(ui16Low < ui16High)
+    {
+        ui16Mid = (ui16Low + ui16High) / 2;
+
+        if(g_psOpcodes[ui16Mid].ui16Code == ui16Code)
+        {
+            return(&g_psOpcodes[ui16Mid]);
+        }
+        else if(g_psOpcodes[ui16Mid].ui16Code < ui16Code)
+        {
+            ui16Low = ui16Mid + 1;
+        }
+        else
+        {
+            ui16High = ui16Mid;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Return the OPCODE_TYPE_* of an opcode's input.
+//
+//*****************************************************************************
+uint16_t
+OpcodeInputType(const tOpcode *psOpcode, uint16_t ui16Input)
+{
+    if((ui16Input >= psOpcode->ui16Inputs) && psOpcode->ui16Inputs)
+    {
+        ui16Input = psOpcode->ui16Inputs - 1;
+    }
+
+    return((uint16_t)(psOpcode->ui32InputTypes >>
+                      (ui16Input * OPCODE_TYPE_BITS)) & OPCODE_TYPE_MASK);
+}
+
+//*****************************************************************************
+//
+// Add an operand to the instruction being compiled.
+//
+//*****************************************************************************
+static tBoolean
+AddOperand(uint16_t ui16Slot)
+{
+    if(g_ui16NumOperands >= ENGINE_MAX_OPERANDS)
+    {
+        return(false);
+    }
+
+    g_pui16Operands[g_ui16NumOperands++] = ui16Slot;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Place a "set" value in the constant area of the value table and add it as
+// an operand.  An int16 value is sign extended to fill the slot like every
+// other int16 value.
+//
+//*****************************************************************************
+static tBoolean
+AddConstant(uint16_t ui16Type, uint32_t ui32Value)
+{
+    uint16_t ui16Slot;
+
+    if(g_ui16NumConstants >= ENGINE_MAX_CONSTANTS)
+    {
+        return(false);
+    }
+
+    ui16Slot = ENGINE_MAX_TILES + g_ui16NumConstants++;
+    g_psValues[ui16Slot].i32 = (ui16Type == OPCODE_TYPE_INT16) ?
+                               (int16_t)ui32Value : (int32_t)ui32Value;
+
+    return(AddOperand(ui16Slot));
+}
+
+//*****************************************************************************
+//
+// Start compiling a tile call to the function with the given code.
+//
+// \return Returns the instruction, or 0 if the function is unknown or the
+// program is out of room.
+//
+//*****************************************************************************
+static tInstruction *
+BeginInstruction(uint16_t ui16Code)
+{
+    tInstruction *psInst;
+
+    if(g_ui16NumInstructions >= ENGINE_MAX_INSTRUCTIONS)
+    {
+        return(0);
+    }
+
+    psInst = &g_psInstructions[g_ui16NumInstructions];
+
+    //
+    // Resolve the function code to its opcode once, here.
+    //
+    psInst->psOpcode = OpcodeFind(ui16Code);
+    if(psInst->psOpcode == 0)
+    {
+        return(0);
+    }
+
+    //
+    // Give the tile its own state slots.
+    //
+    if(g_ui16NumStates + psInst->psOpcode->ui16States > ENGINE_MAX_STATES)
+    {
+        return(0);
+    }
+    psInst->ui16State = ENGINE_MAX_TILES + ENGINE_MAX_CONSTANTS +
+                        g_ui16NumStates;
+    g_ui16NumStates += psInst->psOpcode->ui16States;
+
+    //
+    // A CLA tile's first state slot is its CLA job.
+    //
+    if(psInst->psOpcode->ui16Flags & OPCODE_FLAG_CLA)
+    {
+        if((psInst->psOpcode->ui16States == 0) ||
+           (g_ui16NumClaJobs >= CLA_MAX_JOBS))
+        {
+            return(0);
+        }
+        g_psValues[psInst->ui16State].i32 = g_ui16NumClaJobs++;
+    }
+
+    psInst->ui16Output = ENGINE_NO_OUTPUT;
+    psInst->ui16First = g_ui16NumOperands;
+
+    return(psInst);
+}
+
+//*****************************************************************************
+//
+// Finish the instruction started by BeginInstruction() once all of its
+// operands have been added.
+//
+//*****************************************************************************
+static tBoolean
+EndInstruction(tInstruction *psInst)
+{
+    psInst->ui16Count = g_ui16NumOperands - psInst->ui16First;
+    if(psInst->ui16Count > ENGINE_MAX_INPUTS)
+    {
+        return(false);
+    }
+    g_ui16NumInstructions++;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Start a task whose instructions are those compiled until EndTask().
+//
+//*****************************************************************************
+static tBoolean
+BeginTask(uint16_t ui16Period, uint16_t ui16Priority)
+{
+    tTask *psTask;
+
+    if(g_ui16NumTasks >= ENGINE_MAX_TASKS)
+    {
+        return(false);
+    }
+
+    psTask = &g_psTasks[g_ui16NumTasks];
+    psTask->ui16First = g_ui16NumInstructions;
+    psTask->ui16Count = 0;
+    psTask->ui16Period = ui16Period;
+    psTask->ui16Priority = ui16Priority;
+    psTask->ui16Countdown = ui16Period;
+    psTask->ui32LastRun = 0;
+    psTask->bReady = false;
+    psTask->bRunning = false;
+
+    return(true);
+}
+
+static void
+EndTask(void)
+{
+    tTask *psTask;
+
+    psTask = &g_psTasks[g_ui16NumTasks++];
+    psTask->ui16Count = g_ui16NumInstructions - psTask->ui16First;
+}
+
+//*****************************************************************************
+//
+// Read the decimal tile number at pcProgram[*pui32Index], advancing the
+// index past it.
+//
+// \return Returns \b false if there is no number or it is not a tile.
+//
+//*****************************************************************************
+static tBoolean
+ParseTile(const char *pcProgram, uint32_t ui32Length, uint32_t *pui32Index,
+          uint16_t *pui16Tile)
+{
+    uint32_t k;
+    uint16_t ui16Tile;
+
+    k = *pui32Index;
+    ui16Tile = 0;
+
+    while((k < ui32Length) && (pcProgram[k] >= '0') && (pcProgram[k] <= '9'))
+    {
+        ui16Tile = (ui16Tile * 10) + (pcProgram[k++] - '0');
+        if(ui16Tile >= ENGINE_MAX_TILES)
+        {
+            return(false);
+        }
+    }
+
+    if(k == *pui32Index)
+    {
+        return(false);
+    }
+
+    *pui32Index = k;
+    *pui16Tile = ui16Tile;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Check the compiled program as a whole, once, so that EngineScan() needs no
+// checks of its own:
+//
+// - every tile has exactly one output slot, not shared with another tile;
+// - every tile has the number of inputs its opcode takes, with its "set"
+//   inputs fed from constants and its other inputs from tile outputs of the
+//   same value type;
+// - every output of a task read by that task has already been written
+//   earlier in its list, which is the dependency order the host compiles
+//   in.  Outputs of other tasks are read as of their last run;
+// - there is at most one background task, no task is empty and the CLA
+//   tiles, whose jobs the background scan starts, and the other background
+//   only tiles are all in it.
+//
+// \return Returns \b true if the program may be scanned.
+//
+//*****************************************************************************
+static tBoolean
+EngineVerify(void)
+{
+    const tTask *psTask;
+    const tInstruction *psInst;
+    const tOpcode *psOpcode;
+    uint16_t pui16Written[(ENGINE_MAX_TILES + 15) / 16];
+    uint16_t pui16Types[(ENGINE_MAX_TILES + 7) / 8];
+    uint16_t pui16Own[(ENGINE_MAX_TILES + 15) / 16];
+    uint16_t pui16Done[(ENGINE_MAX_TILES + 15) / 16];
+    uint16_t ui16Task, ui16Inst, n, ui16Slot, ui16Type, ui16Bit;
+    tBoolean bConstant, bBackground;
+
+    memset(pui16Written, 0, sizeof(pui16Written));
+    memset(pui16Types, 0, sizeof(pui16Types));
+
+    //
+    // Every tile writes its own slot, which fixes the type of the slot.
+    //
+    psInst = g_psInstructions;
+
+    for(ui16Inst = 0; ui16Inst < g_ui16NumInstructions; ui16Inst++, psInst++)
+    {
+        if((psInst->ui16Output >= ENGINE_MAX_TILES) ||
+           (pui16Written[psInst->ui16Output / 16] &
+            (1 << (psInst->ui16Output % 16))))
+        {
+            return(false);
+        }
+        pui16Written[psInst->ui16Output / 16] |=
+            1 << (psInst->ui16Output % 16);
+        pui16Types[psInst->ui16Output / 8] |=
+            psInst->psOpcode->ui16OutputType <<
+            ((psInst->ui16Output % 8) * OPCODE_TYPE_BITS);
+    }
+
+    bBackground = false;
+
+    for(ui16Task = 0; ui16Task < g_ui16NumTasks; ui16Task++)
+    {
+        psTask = &g_psTasks[ui16Task];
+
+        if((psTask->ui16Count == 0) ||
+           (psTask->ui16Priority > ENGINE_MAX_PRIORITY) ||
+           ((psTask->ui16Period == 0) && bBackground))
+        {
+            return(false);
+        }
+        bBackground |= (psTask->ui16Period == 0);
+
+        //
+        // Mark the slots the task writes itself.
+        //
+        memset(pui16Own, 0, sizeof(pui16Own));
+        memset(pui16Done, 0, sizeof(pui16Done));
+
+        psInst = &g_psInstructions[psTask->ui16First];
+        for(ui16Inst = 0; ui16Inst < psTask->ui16Count; ui16Inst++, psInst++)
+        {
+            pui16Own[psInst->ui16Output / 16] |=
+                1 << (psInst->ui16Output % 16);
+        }
+
+        psInst = &g_psInstructions[psTask->ui16First];
+        for(ui16Inst = 0; ui16Inst < psTask->ui16Count; ui16Inst++, psInst++)
+        {
+            psOpcode = psInst->psOpcode;
+
+            if((psInst->ui16Count < psOpcode->ui16Inputs) ||
+               ((psInst->ui16Count > psOpcode->ui16Inputs) &&
+                !(psOpcode->ui16Flags & OPCODE_FLAG_VARIADIC)) ||
+               (psTask->ui16Period &&
+                (psOpcode->ui16Flags &
+                 (OPCODE_FLAG_CLA | OPCODE_FLAG_BACKGROUND))))
+            {
+                return(false);
+            }
+
+            for(n = 0; n < psInst->ui16Count; n++)
+            {
+                ui16Slot = g_pui16Operands[psInst->ui16First + n];
+                bConstant = (ui16Slot >= ENGINE_MAX_TILES);
+
+                if((n < 16) &&
+                   (((psOpcode->ui16SetMask >> n) & 1) != bConstant))
+                {
+                    return(false);
+                }
+
+                if(bConstant)
+                {
+                    continue;
+                }
+
+                ui16Bit = 1 << (ui16Slot % 16);
+                ui16Type = (pui16Types[ui16Slot / 8] >>
+                            ((ui16Slot % 8) * OPCODE_TYPE_BITS)) &
+                           OPCODE_TYPE_MASK;
+                if(!(pui16Written[ui16Slot / 16] & ui16Bit) ||
+                   (ui16Type != OpcodeInputType(psOpcode, n)) ||
+                   ((pui16Own[ui16Slot / 16] & ui16Bit) &&
+                    !(pui16Done[ui16Slot / 16] & ui16Bit)))
+                {
+                    return(false);
+                }
+            }
+
+            pui16Done[psInst->ui16Output / 16] |=
+                1 << (psInst->ui16Output % 16);
+        }
+    }
+
+    return(g_ui16NumInstructions != 0);
+}
+
+//*****************************************************************************
+//
+// List the timed tasks by priority, keeping the program's order between
+// tasks of equal priority, and find the background task.
+//
+//*****************************************************************************
+static void
+EngineOrderTasks(void)
+{
+    uint16_t ui16Task, n;
+
+    g_ui16NumTimed = 0;
+    g_ui16Background = ENGINE_NO_TASK;
+
+    for(ui16Task = 0; ui16Task < g_ui16NumTasks; ui16Task++)
+    {
+        if(g_psTasks[ui16Task].ui16Period == 0)
+        {
+            g_ui16Background = ui16Task;
+            continue;
+        }
+
+        for(n = g_ui16NumTimed;
+            (n > 0) && (g_psTasks[g_pui16TaskOrder[n - 1]].ui16Priority <
+                        g_psTasks[ui16Task].ui16Priority);
+            n--)
+        {
+            g_pui16TaskOrder[n] = g_pui16TaskOrder[n - 1];
+        }
+        g_pui16TaskOrder[n] = ui16Task;
+        g_ui16NumTimed++;
+    }
+}
+
+//*****************************************************************************
+//
+// Parse a UPL v1 text program into the instruction list.
+//
+//*****************************************************************************
+static tBoolean
+EngineParseText(const char *pcProgram, uint32_t ui32Length)
+{
+    tInstruction *psInst;
+    char pcFunction[7];
+    char pcValue[32];
+    uint32_t k;
+    uint16_t ui16Tile, ui16Len;
+
+    k = 0;
+    while(k + 6 <= ui32Length)
+    {
+        memcpy(pcFunction, &pcProgram[k], 6);
+        pcFunction[6] = '\0';
+        psInst = BeginInstruction((uint16_t)strtoul(pcFunction, 0, 16));
+        if(psInst == 0)
+        {
+            return(false);
+        }
+        k += 6;
+
+        while((k < ui32Length) && (pcProgram[k] != '#'))
+        {
+            //
+            // Relative input, the output of another tile.
+            //
+            if((pcProgram[k] == 'i') && (k + 1 < ui32Length) &&
+               (pcProgram[k + 1] == 'o'))
+            {
+                k += 2;
+                if(!ParseTile(pcProgram, ui32Length, &k, &ui16Tile) ||
+                   !AddOperand(ui16Tile))
+                {
+                    return(false);
+                }
+            }
+
+            //
+            // Absolute input, a set value in hex.  32-bit types give all 32
+            // bits, so a float is given as its IEEE 754 bit pattern.
+            //
+            else if(pcProgram[k] == 'i')
+            {
+                k++;
+                ui16Len = 0;
+                while((k < ui32Length) && (pcProgram[k] != 'i') &&
+                      (pcProgram[k] != 'o') && (pcProgram[k] != '#'))
+                {
+                    if(ui16Len == sizeof(pcValue) - 1)
+                    {
+                        return(false);
+                    }
+                    pcValue[ui16Len++] = pcProgram[k++];
+                }
+                pcValue[ui16Len] = '\0';
+
+                if((ui16Len == 0) ||
+                   !AddConstant(OpcodeInputType(psInst->psOpcode,
+                                                g_ui16NumOperands -
+                                                psInst->ui16First),
+                                strtoul(pcValue, 0, 16)))
+                {
+                    return(false);
+                }
+            }
+
+            //
+            // The tile's own output, given once.
+            //
+            else if((pcProgram[k] == 'o') &&
+                    (psInst->ui16Output == ENGINE_NO_OUTPUT))
+            {
+                k++;
+                if(!ParseTile(pcProgram, ui32Length, &k,
+                              &psInst->ui16Output))
+                {
+                    return(false);
+                }
+            }
+            else
+            {
+                return(false);
+            }
+        }
+
+        if(!EndInstruction(psInst))
+        {
+            return(false);
+        }
+
+        //
+        // A second '#' ends the program.
+        //
+        k++;
+        if((k < ui32Length) && (pcProgram[k] == '#'))
+        {
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Read a 16-bit field of a UPL v2 program.  Only the low byte of each
+// character is used since that is all that was received over USB.
+//
+//*****************************************************************************
+static uint16_t
+Get16(const char *pcProgram, uint32_t ui32Index)
+{
+    return((pcProgram[ui32Index] & 0xFF) |
+           ((uint16_t)(pcProgram[ui32Index + 1] & 0xFF) << 8));
+}
+
+//*****************************************************************************
+//
+// Parse ui16Tiles UPL v2 tile calls at pcProgram[*pui32Index] into the
+// instruction list, advancing the index past them.
+//
+//*****************************************************************************
+static tBoolean
+EngineParseTiles(const char *pcProgram, uint32_t ui32Length,
+                 uint32_t *pui32Index, uint16_t ui16Tiles)
+{
+    tInstruction *psInst;
+    uint32_t k, ui32Value;
+    uint16_t ui16Count, ui16Type, n;
+
+    k = *pui32Index;
+
+    while(ui16Tiles--)
+    {
+        if(k + 6 > ui32Length)
+        {
+            return(false);
+        }
+
+        psInst = BeginInstruction(Get16(pcProgram, k));
+        if(psInst == 0)
+        {
+            return(false);
+        }
+        psInst->ui16Output = Get16(pcProgram, k + 2);
+        ui16Count = Get16(pcProgram, k + 4);
+        k += 6;
+
+        if(ui16Count > ENGINE_MAX_INPUTS)
+        {
+            return(false);
+        }
+
+        for(n = 0; n < ui16Count; n++)
+        {
+            if(k + 2 > ui32Length)
+            {
+                return(false);
+            }
+            ui32Value = Get16(pcProgram, k);
+            k += 2;
+
+            if((n < 16) && ((psInst->psOpcode->ui16SetMask >> n) & 1))
+            {
+                //
+                // Set values of 32-bit types take a second field for the
+                // high half.
+                //
+                ui16Type = OpcodeInputType(psInst->psOpcode, n);
+                if(ui16Type != OPCODE_TYPE_INT16)
+                {
+                    if(k + 2 > ui32Length)
+                    {
+                        return(false);
+                    }
+                    ui32Value |= (uint32_t)Get16(pcProgram, k) << 16;
+                    k += 2;
+                }
+
+                if(!AddConstant(ui16Type, ui32Value))
+                {
+                    return(false);
+                }
+            }
+            else if((ui32Value >= ENGINE_MAX_TILES) ||
+                    !AddOperand((uint16_t)ui32Value))
+            {
+                return(false);
+            }
+        }
+
+        if(!EndInstruction(psInst))
+        {
+            return(false);
+        }
+    }
+
+    *pui32Index = k;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Parse a UPL v2 or v3 binary program into the instruction list.  A v2
+// program is all one background task.  The whole program must be used, with
+// nothing left over.
+//
+//*****************************************************************************
+static tBoolean
+EngineParseBinary(const char *pcProgram, uint32_t ui32Length)
+{
+    uint32_t k;
+    uint16_t ui16Tasks;
+
+    k = UPL_HEADER_SIZE;
+
+    if(Get16(pcProgram, 2) == UPL_VERSION)
+    {
+        if(!BeginTask(0, 0) ||
+           !EngineParseTiles(pcProgram, ui32Length, &k, Get16(pcProgram, 4)))
+        {
+            return(false);
+        }
+        EndTask();
+    }
+    else if(Get16(pcProgram, 2) == UPL_VERSION_TASKS)
+    {
+        ui16Tasks = Get16(pcProgram, 4);
+
+        while(ui16Tasks--)
+        {
+            if((k + 6 > ui32Length) ||
+               !BeginTask(Get16(pcProgram, k), Get16(pcProgram, k + 2)))
+            {
+                return(false);
+            }
+            k += 6;
+
+            if(!EngineParseTiles(pcProgram, ui32Length, &k,
+                                 Get16(pcProgram, k - 2)))
+            {
+                return(false);
+            }
+            EndTask();
+        }
+    }
+    else
+    {
+        return(false);
+    }
+
+    return(k == ui32Length);
+}
+
+//*****************************************************************************
+//
+// Compile a UPL program.
+//
+// \param pcProgram is the program text as uploaded by the host.
+// \param ui32Length is the number of characters in the program.
+//
+// A UPL v2 or v3 program is decoded as described in engine.h.  Otherwise the
+// program is UPL v1 text, where each tile call is a six character function
+// code such as "0xA001", followed by its inputs and output and terminated by
+// '#'.  "io<n>" is the output of tile n, "i<hex>" is a set value and "o<n>"
+// is the tile's own output, with n in decimal.  The program ends with a
+// second '#'.
+//
+// The program is checked in full here; one that fails is dropped so that
+// nothing is scanned.  The timed tasks of the old program are stopped, and
+// those of the new one wait for EngineStartTasks().
+//
+// \return Returns \b true if the program was compiled and can be scanned.
+//
+//*****************************************************************************
+tBoolean
+EngineLoad(const char *pcProgram, uint32_t ui32Length)
+{
+    tBoolean bParsed;
+
+    EngineStopTasks();
+    ClaReset();
+    PwmReset();
+    PulseReset();
+
+    g_ui16NumInstructions = 0;
+    g_ui16NumOperands = 0;
+    g_ui16NumConstants = 0;
+    g_ui16NumStates = 0;
+    g_ui16NumClaJobs = 0;
+    g_ui16NumTasks = 0;
+    g_ui16NumTimed = 0;
+    g_ui16Background = ENGINE_NO_TASK;
+    memset(g_psValues, 0, sizeof(g_psValues));
+    g_ui32LastScan = g_ui32Ticks;
+
+    if((ui32Length >= UPL_HEADER_SIZE) &&
+       ((pcProgram[0] & 0xFF) == UPL_MAGIC_0) &&
+       ((pcProgram[1] & 0xFF) == UPL_MAGIC_1))
+    {
+        bParsed = EngineParseBinary(pcProgram, ui32Length);
+    }
+    else
+    {
+        BeginTask(0, 0);
+        bParsed = EngineParseText(pcProgram, ui32Length);
+        EndTask();
+    }
+
+    if(!bParsed || !EngineVerify())
+    {
+        g_ui16NumInstructions = 0;
+        g_ui16NumClaJobs = 0;
+        g_ui16NumTasks = 0;
+        return(false);
+    }
+
+    EngineOrderTasks();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Run every instruction of a task once, in order.
+//
+//*****************************************************************************
+static void
+EngineRun(const tTask *psTask, tOperands *psOperands)
+{
+    const tInstruction *psInst;
+    const tOpcode *psOpcode;
+    const uint16_t *pui16Operand;
+    uint16_t ui16Inst, n;
+
+    psInst = &g_psInstructions[psTask->ui16First];
+
+    for(ui16Inst = 0; ui16Inst < psTask->ui16Count; ui16Inst++, psInst++)
+    {
+        psOpcode = psInst->psOpcode;
+        pui16Operand = &g_pui16Operands[psInst->ui16First];
+
+        if(psOpcode->pfnValueHandler)
+        {
+            for(n = 0; n < psInst->ui16Count; n++)
+            {
+                psOperands->psInputs[n] = g_psValues[pui16Operand[n]];
+            }
+
+            g_psValues[psInst->ui16Output] =
+                psOpcode->pfnValueHandler(psOperands->psInputs,
+                                          psInst->ui16Count,
+                                          &g_psValues[psInst->ui16State]);
+        }
+        else
+        {
+            for(n = 0; n < psInst->ui16Count; n++)
+            {
+                psOperands->piInputs[n] = (int)g_psValues[pui16Operand[n]].i32;
+            }
+
+            g_psValues[psInst->ui16Output].i32 =
+                psOpcode->pfnHandler(psOperands->piInputs, psInst->ui16Count,
+                                     (int *)&g_psValues[psInst->ui16State]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Run the background task once, then start the CLA on the jobs the CLA
+// tiles staged.
+//
+//*****************************************************************************
+void
+EngineScan(void)
+{
+    uint32_t ui32Now;
+
+    //
+    // Advance the timebase seen by timer tiles.
+    //
+    ui32Now = g_ui32Ticks;
+    g_ui16ScanElapsed = (uint16_t)(ui32Now - g_ui32LastScan);
+    g_ui32LastScan = ui32Now;
+
+    //
+    // The CLA tiles read the results of the jobs started by the last scan.
+    //
+    ClaWait();
+
+    if(g_ui16Background != ENGINE_NO_TASK)
+    {
+        EngineRun(&g_psTasks[g_ui16Background],
+                  &g_psOperands[g_ui16Background]);
+    }
+
+    ClaStart(g_ui16NumClaJobs);
+}
+
+//*****************************************************************************
+//
+// Start releasing the timed tasks, each first due one period from now.
+//
+//*****************************************************************************
+void
+EngineStartTasks(void)
+{
+    tTask *psTask;
+    uint16_t n, ui16Status;
+
+    ui16Status = __disable_interrupts();
+
+    for(n = 0; n < g_ui16NumTimed; n++)
+    {
+        psTask = &g_psTasks[g_pui16TaskOrder[n]];
+        psTask->ui16Countdown = psTask->ui16Period;
+        psTask->ui32LastRun = g_ui32Ticks;
+        psTask->bReady = false;
+    }
+    g_bTasksRunning = true;
+
+    __restore_interrupts(ui16Status);
+}
+
+//*****************************************************************************
+//
+// Stop releasing the timed tasks and drop any that are due.  This is called
+// from the main loop, so no timed task is part way through.
+//
+//*****************************************************************************
+void
+EngineStopTasks(void)
+{
+    uint16_t n, ui16Status;
+
+    ui16Status = __disable_interrupts();
+
+    g_bTasksRunning = false;
+    for(n = 0; n < g_ui16NumTimed; n++)
+    {
+        g_psTasks[g_pui16TaskOrder[n]].bReady = false;
+    }
+
+    __restore_interrupts(ui16Status);
+}
+
+//*****************************************************************************
+//
+// Run each timed task once, highest priority first, as if a period had
+// passed.  This is for single stepping from the main loop while the tasks
+// are stopped.
+//
+//*****************************************************************************
+void
+EngineStepTasks(void)
+{
+    const tTask *psTask;
+    uint16_t n, ui16Elapsed;
+
+    ui16Elapsed = g_ui16ScanElapsed;
+
+    for(n = 0; n < g_ui16NumTimed; n++)
+    {
+        psTask = &g_psTasks[g_pui16TaskOrder[n]];
+        g_ui16ScanElapsed = psTask->ui16Period;
+        EngineRun(psTask, &g_psOperands[g_pui16TaskOrder[n]]);
+    }
+
+    g_ui16ScanElapsed = ui16Elapsed;
+}
+
+//*****************************************************************************
+//
+// Count down the timed tasks and mark those that fall due.  This is called
+// from the CPU timer 0 interrupt every tick.
+//
+// \return Returns \b false if a task fell due while it was still waiting or
+// running from its last period.
+//
+//*****************************************************************************
+tBoolean
+EngineRelease(void)
+{
+    tTask *psTask;
+    uint16_t n;
+    tBoolean bMet;
+
+    bMet = true;
+
+    if(!g_bTasksRunning)
+    {
+        return(bMet);
+    }
+
+    for(n = 0; n < g_ui16NumTimed; n++)
+    {
+        psTask = &g_psTasks[g_pui16TaskOrder[n]];
+
+        if(--psTask->ui16Countdown)
+        {
+            continue;
+        }
+        psTask->ui16Countdown = psTask->ui16Period;
+
+        if(psTask->bReady || psTask->bRunning)
+        {
+            bMet = false;
+        }
+        else
+        {
+            psTask->bReady = true;
+        }
+    }
+
+    return(bMet);
+}
+
+//*****************************************************************************
+//
+// Run the tasks that are due and of higher priority than the one this tick
+// interrupted.  This is called from the CPU timer 0 interrupt once the PIE
+// has been acknowledged, with interrupts disabled.  They are enabled while
+// each task runs, so a later tick can release and run a task of higher
+// priority in its own, nested, call.
+//
+//*****************************************************************************
+void
+EngineDispatch(void)
+{
+    tTask *psTask;
+    uint16_t n, ui16Task, ui16Level, ui16Elapsed;
+    uint32_t ui32Now;
+
+    ui16Level = g_ui16TaskLevel;
+    n = 0;
+
+    while(g_bTasksRunning && (n < g_ui16NumTimed))
+    {
+        ui16Task = g_pui16TaskOrder[n++];
+        psTask = &g_psTasks[ui16Task];
+
+        if(psTask->ui16Priority < ui16Level)
+        {
+            break;
+        }
+        if(!psTask->bReady)
+        {
+            continue;
+        }
+
+        psTask->bReady = false;
+        psTask->bRunning = true;
+        g_ui16TaskLevel = psTask->ui16Priority + 1;
+
+        //
+        // The task's timer tiles see the time since it last ran, and the
+        // scan it interrupted gets its own back afterwards.
+        //
+        ui16Elapsed = g_ui16ScanElapsed;
+        ui32Now = g_ui32Ticks;
+        g_ui16ScanElapsed = (uint16_t)(ui32Now - psTask->ui32LastRun);
+        psTask->ui32LastRun = ui32Now;
+
+        IER |= M_INT1;
+        EINT;
+        EngineRun(psTask, &g_psOperands[ui16Task]);
+        DINT;
+
+        g_ui16ScanElapsed = ui16Elapsed;
+        g_ui16TaskLevel = ui16Level;
+        psTask->bRunning = false;
+
+        //
+        // Tasks may have fallen due meanwhile, so look again from the top.
+        //
+        n = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Advance the scan timebase by one millisecond.  This is called from the CPU
+// timer 0 interrupt.
+//
+//*****************************************************************************
+void
+EngineTick(void)
+{
+    g_ui32Ticks++;
+}
+
+//*****************************************************************************
+//
+// Return the milliseconds since boot.
+//
+//*****************************************************************************
+uint32_t
+EngineTime(void)
+{
+    return(g_ui32Ticks);
+}
+
+//*****************************************************************************
+//
+// Read a value table slot, for the host.  Slots below ENGINE_MAX_TILES are
+// tile outputs, numbered as in the program.  The value is the slot's 32
+// bits, which the host interprets by the type of the tile that owns it.
+//
+// \return Returns \b false if the slot does not exist.
+//
+//*****************************************************************************
+tBoolean
+EngineReadValue(uint16_t ui16Slot, int32_t *pi32Value)
+{
+    if(ui16Slot >= ENGINE_MAX_VALUES)
+    {
+        return(false);
+    }
+
+    *pi32Value = g_psValues[ui16Slot].i32;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Overwrite a value table slot, for the host.  A tile output written here is
+// seen by the tiles that read it until the tile itself next runs.
+//
+// \return Returns \b false if the slot does not exist.
+//
+//*****************************************************************************
+tBoolean
+EngineWriteValue(uint16_t ui16Slot, int32_t i32Value)
+{
+    if(ui16Slot >= ENGINE_MAX_VALUES)
+    {
+        return(false);
+    }
+
+    g_psValues[ui16Slot].i32 = i32Value;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Report how much of each table the loaded program uses, for the host.
+//
+//*****************************************************************************
+void
+EngineUsage(tEngineUsage *psUsage)
+{
+    psUsage->ui16Instructions = g_ui16NumInstructions;
+    psUsage->ui16Operands = g_ui16NumOperands;
+    psUsage->ui16Constants = g_ui16NumConstants;
+    psUsage->ui16States = g_ui16NumStates;
+}
@@ -0,0 +1,107 @@
+//###########################################################################
+//
+// FILE:   engine.h
+//
+// TITLE:  User program execution engine.
+//
+//###########################################################################
+
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+//*****************************************************************************
+//
+// Capacity of the compiled program.  Tile outputs occupy the first
+// ENGINE_MAX_TILES slots of the value table, the "set" constants used by the
+// program are placed after them and the state of stateful tiles comes last.
+//
+//*****************************************************************************
+#define ENGINE_MAX_TILES            512
+#define ENGINE_MAX_CONSTANTS        256
+#define ENGINE_MAX_STATES           256
+#define ENGINE_MAX_VALUES           (ENGINE_MAX_TILES + ENGINE_MAX_CONSTANTS +\
+                                     ENGINE_MAX_STATES)
+#define ENGINE_MAX_INSTRUCTIONS     512
+#define ENGINE_MAX_OPERANDS         1024
+#define ENGINE_MAX_INPUTS           32
+
+//*****************************************************************************
+//
+// Tasks.  A program is split into up to ENGINE_MAX_TASKS tasks, each with its
+// own instructions.  A task with a period of 0 is the background task, run
+// by EngineScan() from the main loop as fast as it goes; there is at most
+// one.  The others run every period milliseconds from the timer interrupt,
+// pre-empting the background task and any timed task of lower priority.
+//
+//*****************************************************************************
+#define ENGINE_MAX_TASKS            4
+#define ENGINE_MAX_PRIORITY         255
+
+//*****************************************************************************
+//
+// UPL v2, the binary program encoding.  After the two magic bytes every
+// field is 16-bit little endian:
+//
+//     'U', 'P', version (2), tile count
+//     per tile: function code, output tile, input count, inputs...
+//
+// UPL v3 splits the tiles into tasks, and a v2 program is one background
+// task:
+//
+//     'U', 'P', version (3), task count
+//     per task: period (ms, 0 for background), priority, tile count
+//               per tile: as in v2
+//
+// An input is a tile number, or the value itself for inputs the opcode
+// declares "set".  A set value of a 32-bit type (see opcodes.h) takes two
+// fields, low half first, and counts as one input.  A program that does not
+// start with the magic is taken to be UPL v1 text.
+//
+//*****************************************************************************
+#define UPL_MAGIC_0                 'U'
+#define UPL_MAGIC_1                 'P'
+#define UPL_VERSION                 2
+#define UPL_VERSION_TASKS           3
+#define UPL_HEADER_SIZE             6
+
+//*****************************************************************************
+//
+// The scan timebase.  EngineTick() is called every millisecond and
+// g_ui16ScanElapsed holds the milliseconds between the start of the previous
+// scan and the start of the current one, for timer tiles to accumulate.
+// While a timed task runs it holds the milliseconds since that task last
+// ran instead.
+//
+//*****************************************************************************
+#define ENGINE_TICK_HZ              1000
+
+extern uint16_t g_ui16ScanElapsed;
+
+//*****************************************************************************
+//
+// Table use of the loaded program, against the ENGINE_MAX_ limits above.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Instructions;
+    uint16_t ui16Operands;
+    uint16_t ui16Constants;
+    uint16_t ui16States;
+}
+tEngineUsage;
+
+extern tBoolean EngineLoad(const char *pcProgram, uint32_t ui32Length);
+extern void EngineScan(void);
+extern void EngineStartTasks(void);
+extern void EngineStopTasks(void);
+extern void EngineStepTasks(void);
+extern tBoolean EngineRelease(void);
+extern void EngineDispatch(void);
+extern void EngineTick(void);
+extern uint32_t EngineTime(void);
+extern tBoolean EngineReadValue(uint16_t ui16Slot, int32_t *pi32Value);
+extern tBoolean EngineWriteValue(uint16_t ui16Slot, int32_t i32Value);
+extern void EngineUsage(tEngineUsage *psUsage);
+
+#endif // __ENGINE_H__
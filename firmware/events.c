@@ -0,0 +1,71 @@
+//###########################################################################
+//
+// FILE:   events.c
+//
+// TITLE:  Deferred work posted from interrupts to the main loop.
+//
+// An interrupt handler that has work to do posts an event and returns; the
+// handler registered for the event then runs from the main loop with
+// interrupts enabled.  Each event is a single pending flag, so posting is
+// one store that is safe from any context, and an event posted several
+// times before it is dispatched runs its handler once.
+//
+//###########################################################################
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "events.h"
+
+static volatile uint16_t g_pui16Pending[EVENT_NUM_EVENTS];
+static tEventHandler g_ppfnHandlers[EVENT_NUM_EVENTS];
+
+//*****************************************************************************
+//
+// Set the function run from the main loop when an event is posted.
+//
+//*****************************************************************************
+void
+EventRegister(uint16_t ui16Event, tEventHandler pfnHandler)
+{
+    g_ppfnHandlers[ui16Event] = pfnHandler;
+}
+
+//*****************************************************************************
+//
+// Mark an event pending.  This may be called from interrupt context.
+//
+//*****************************************************************************
+void
+EventPost(uint16_t ui16Event)
+{
+    g_pui16Pending[ui16Event] = 1;
+}
+
+//*****************************************************************************
+//
+// Run the handler of every pending event.  This is called from the main loop.
+//
+// The flag is cleared before the handler runs so that an event posted while
+// its handler is running is dispatched again on the next pass.
+//
+//*****************************************************************************
+void
+EventDispatch(void)
+{
+    uint16_t ui16Event;
+
+    for(ui16Event = 0; ui16Event < EVENT_NUM_EVENTS; ui16Event++)
+    {
+        if(g_pui16Pending[ui16Event])
+        {
+            g_pui16Pending[ui16Event] = 0;
+
+            if(g_ppfnHandlers[ui16Event])
+            {
+                g_ppfnHandlers[ui16Event]();
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+//###########################################################################
+//
+// FILE:   events.h
+//
+// TITLE:  Deferred work posted from interrupts to the main loop.
+//
+//###########################################################################
+
+#ifndef __EVENTS_H__
+#define __EVENTS_H__
+
+//*****************************************************************************
+//
+// The events.  Pending events are dispatched in this order, once per pass of
+// the main loop.
+//
+//*****************************************************************************
+#define EVENT_USB_CONNECTED         0
+#define EVENT_USB_RX                1
+#define EVENT_USB_REPLY             2
+#define EVENT_FAULT                 3
+#define EVENT_PATTERN               4
+#define EVENT_NUM_EVENTS            5
+
+typedef void (*tEventHandler)(void);
+
+extern void EventRegister(uint16_t ui16Event, tEventHandler pfnHandler);
+extern void EventPost(uint16_t ui16Event);
+extern void EventDispatch(void);
+
+#endif // __EVENTS_H__
@@ -0,0 +1,264 @@
+//###########################################################################
+//
+// FILE:   expansion.c
+//
+// TITLE:  SPI expansion bus for add-on I/O boards.
+//
+// The add-on boards form a chain of shift registers on SPI-B: 74HC595s for
+// outputs and 74HC165s for inputs, both clocked by SPICLKB (GPIO26), with
+// the 595s fed from SPISIMOB (GPIO24) and the last 165 driving SPISOMIB
+// (GPIO25).  GPIO27 is the latch: while it is low the 165s load their
+// inputs, and its rising edge moves the bits shifted into the 595s to their
+// pins.  Board n is the nth register of each chain counting from this end.
+//
+// The tiles only read and write RAM.  The whole chain is shifted once per
+// scan as one burst of 16-bit words that fits the SPI FIFO, so the bus is
+// never polled byte by byte and its time per scan is fixed however many
+// tiles use it:
+//
+//  - ExpansionFlush() at the end of a scan queues the outputs in the
+//    transmit FIFO and returns while the hardware shifts them out.
+//  - ExpansionUpdate() at the start of the next scan collects the inputs
+//    from the receive FIFO, by then long since complete, and pulses the
+//    latch to show the outputs and sample the inputs for the next burst.
+//
+// Outputs therefore change at the start of the scan after the one that set
+// them, and inputs are as of the start of the scan before.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "expansion.h"
+
+//*****************************************************************************
+//
+// The burst in 16-bit SPI words, two boards to a word.
+//
+//*****************************************************************************
+#define EXPANSION_WORDS             (EXPANSION_BOARDS / 2)
+
+#if (EXPANSION_WORDS > 4) || (EXPANSION_BOARDS & 1)
+#error "EXPANSION_BOARDS must be even and fit the SPI FIFO"
+#endif
+
+//*****************************************************************************
+//
+// Pin mux settings, from the F2806x data manual.
+//
+//*****************************************************************************
+#define EXPANSION_GPIO24_MUX_SIMOB  3
+#define EXPANSION_GPIO25_MUX_SOMIB  3
+#define EXPANSION_GPIO26_MUX_CLKB   3
+
+//*****************************************************************************
+//
+// The bits shifted in and out by the last and next bursts, one byte per
+// board.
+//
+//*****************************************************************************
+static uint16_t g_pui16ExpansionInputs[EXPANSION_BOARDS];
+static uint16_t g_pui16ExpansionOutputs[EXPANSION_BOARDS];
+
+//*****************************************************************************
+//
+// Whether a burst has been queued and not collected, and whether the chain
+// holds the safe state, so that ExpansionSafeOutputs() only shifts once.
+//
+//*****************************************************************************
+static tBoolean g_bExpansionBusy = false;
+static tBoolean g_bExpansionSafe = false;
+
+//*****************************************************************************
+//
+// Take the SPI-B pins and set SPI-B up as master, 16-bit words, data changed
+// on the falling clock edge and sampled on the rising one, FIFOs on.
+//
+//*****************************************************************************
+void
+ExpansionInit(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR0.bit.SPIBENCLK = 1;
+
+    GpioCtrlRegs.GPAPUD.bit.GPIO24 = 0;
+    GpioCtrlRegs.GPAPUD.bit.GPIO25 = 0;
+    GpioCtrlRegs.GPAPUD.bit.GPIO26 = 0;
+    GpioCtrlRegs.GPAQSEL2.bit.GPIO25 = 3;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO24 = EXPANSION_GPIO24_MUX_SIMOB;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO25 = EXPANSION_GPIO25_MUX_SOMIB;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO26 = EXPANSION_GPIO26_MUX_CLKB;
+
+    GpioDataRegs.GPASET.bit.GPIO27 = 1;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO27 = 0;
+    GpioCtrlRegs.GPADIR.bit.GPIO27 = 1;
+    EDIS;
+
+    SpibRegs.SPICCR.bit.SPISWRESET = 0;
+    SpibRegs.SPICCR.bit.SPICHAR = 15;
+    SpibRegs.SPICCR.bit.CLKPOLARITY = 1;
+    SpibRegs.SPICCR.bit.SPILBK = 0;
+    SpibRegs.SPICTL.all = 0;
+    SpibRegs.SPICTL.bit.MASTER_SLAVE = 1;
+    SpibRegs.SPICTL.bit.TALK = 1;
+
+    //
+    // LSPCLK is SYSCLKOUT / 4.
+    //
+    SpibRegs.SPIBRR = (SysCtlClockGet(SYSTEM_CLOCK_SPEED) / 4 /
+                       EXPANSION_SPI_HZ) - 1;
+    SpibRegs.SPIPRI.bit.FREE = 1;
+
+    SpibRegs.SPIFFTX.all = 0;
+    SpibRegs.SPIFFTX.bit.SPIRST = 1;
+    SpibRegs.SPIFFTX.bit.SPIFFENA = 1;
+    SpibRegs.SPIFFTX.bit.TXFFINTCLR = 1;
+    SpibRegs.SPIFFRX.all = 0;
+    SpibRegs.SPIFFRX.bit.RXFFOVFCLR = 1;
+    SpibRegs.SPIFFRX.bit.RXFFINTCLR = 1;
+    SpibRegs.SPIFFCT.all = 0;
+    SpibRegs.SPIFFTX.bit.TXFIFO = 1;
+    SpibRegs.SPIFFRX.bit.RXFIFORESET = 1;
+
+    SpibRegs.SPICCR.bit.SPISWRESET = 1;
+
+    //
+    // Start from a chain with every output off.
+    //
+    ExpansionSafeOutputs();
+}
+
+//*****************************************************************************
+//
+// Collect the inputs of the burst queued by the last ExpansionFlush() and
+// pulse the latch.  This is called at the start of each scan.
+//
+//*****************************************************************************
+void
+ExpansionUpdate(void)
+{
+    uint16_t ui16Word, ui16Data;
+
+    g_bExpansionSafe = false;
+
+    if(!g_bExpansionBusy)
+    {
+        return;
+    }
+
+    //
+    // The burst takes a few microseconds, so it has almost always finished.
+    //
+    while(SpibRegs.SPIFFRX.bit.RXFFST < EXPANSION_WORDS)
+    {
+    }
+
+    //
+    // The first bits in come from the register nearest this end.
+    //
+    for(ui16Word = 0; ui16Word < EXPANSION_WORDS; ui16Word++)
+    {
+        ui16Data = SpibRegs.SPIRXBUF;
+        g_pui16ExpansionInputs[2 * ui16Word] = ui16Data >> 8;
+        g_pui16ExpansionInputs[(2 * ui16Word) + 1] = ui16Data & 0xFF;
+    }
+    g_bExpansionBusy = false;
+
+    //
+    // Hold the latch low long enough for the 74HC165s to load.
+    //
+    GpioDataRegs.GPACLEAR.bit.GPIO27 = 1;
+    __asm(" RPT #15 || NOP");
+    GpioDataRegs.GPASET.bit.GPIO27 = 1;
+}
+
+//*****************************************************************************
+//
+// Queue the outputs set by this scan in the transmit FIFO.  This is called
+// at the end of each scan and returns at once.
+//
+//*****************************************************************************
+void
+ExpansionFlush(void)
+{
+    uint16_t ui16Word, ui16Board;
+
+    if(g_bExpansionBusy)
+    {
+        return;
+    }
+
+    //
+    // The last bits out end up in the register nearest this end.
+    //
+    for(ui16Word = 0; ui16Word < EXPANSION_WORDS; ui16Word++)
+    {
+        ui16Board = EXPANSION_BOARDS - 1 - (2 * ui16Word);
+        SpibRegs.SPITXBUF = (g_pui16ExpansionOutputs[ui16Board] << 8) |
+                            g_pui16ExpansionOutputs[ui16Board - 1];
+    }
+    g_bExpansionBusy = true;
+}
+
+//*****************************************************************************
+//
+// Turn every expansion output off.  This is called from the main loop while
+// no program is in control, and only shifts the chain the first time.
+//
+//*****************************************************************************
+void
+ExpansionSafeOutputs(void)
+{
+    uint16_t ui16Board;
+
+    if(g_bExpansionSafe)
+    {
+        return;
+    }
+
+    for(ui16Board = 0; ui16Board < EXPANSION_BOARDS; ui16Board++)
+    {
+        g_pui16ExpansionOutputs[ui16Board] = 0;
+    }
+
+    ExpansionUpdate();
+    ExpansionFlush();
+    ExpansionUpdate();
+
+    g_bExpansionSafe = true;
+}
+
+//*****************************************************************************
+//
+// Return the eight inputs of a board, or 0 for a board out of range.
+//
+//*****************************************************************************
+uint16_t
+ExpansionRead(uint16_t ui16Board)
+{
+    if(ui16Board >= EXPANSION_BOARDS)
+    {
+        return(0);
+    }
+    return(g_pui16ExpansionInputs[ui16Board]);
+}
+
+//*****************************************************************************
+//
+// Set the eight outputs of a board for the next burst.
+//
+//*****************************************************************************
+void
+ExpansionWrite(uint16_t ui16Board, uint16_t ui16Outputs)
+{
+    if(ui16Board < EXPANSION_BOARDS)
+    {
+        g_pui16ExpansionOutputs[ui16Board] = ui16Outputs & 0xFF;
+    }
+}
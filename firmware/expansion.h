@@ -0,0 +1,36 @@
+//###########################################################################
+//
+// FILE:   expansion.h
+//
+// TITLE:  SPI expansion bus for add-on I/O boards.
+//
+//###########################################################################
+
+#ifndef __EXPANSION_H__
+#define __EXPANSION_H__
+
+//*****************************************************************************
+//
+// The number of add-on boards, each with eight inputs and eight outputs.
+// Every scan shifts all of them in one burst of EXPANSION_BOARDS bytes each
+// way, which must fit the four word SPI FIFO.
+//
+//*****************************************************************************
+#define EXPANSION_BOARDS            8
+
+//*****************************************************************************
+//
+// The SPI bit rate.  A burst takes EXPANSION_BOARDS * 8 bit times, 12.8us
+// for the full chain.
+//
+//*****************************************************************************
+#define EXPANSION_SPI_HZ            5000000
+
+extern void ExpansionInit(void);
+extern void ExpansionUpdate(void);
+extern void ExpansionFlush(void);
+extern void ExpansionSafeOutputs(void);
+extern uint16_t ExpansionRead(uint16_t ui16Board);
+extern void ExpansionWrite(uint16_t ui16Board, uint16_t ui16Outputs);
+
+#endif // __EXPANSION_H__
@@ -0,0 +1,265 @@
+//###########################################################################
+//
+// FILE:   logic.c
+//
+// TITLE:  Logic analyser capture of the input pins.
+//
+// CPU timer 2 interrupts at the sample rate.  Each interrupt reads both GPIO
+// data registers, packs the eight input pins into one byte and run length
+// encodes it into a ring in RAML8: a sample equal to the last only bumps the
+// current run, so steady inputs cost almost nothing to store or send.  The
+// main loop drains the ring to the host in capture frames.
+//
+// Timer 2 is CPU interrupt 14.  The engine's timed tasks run from the CPU
+// timer 0 interrupt with interrupts enabled, so they do not hold a sample
+// up, but a sample can still be late by as long as the longest other
+// interrupt, or the part of the timer 0 interrupt before it lets others
+// in.  The sampling interrupt runs from RAM to keep its own time short.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdcdc.h"
+#include "usb_serial_structs.h"
+#include "protocol.h"
+#include "logic.h"
+
+#if (LOGIC_BUFFER_SIZE & (LOGIC_BUFFER_SIZE - 1))
+#error "LOGIC_BUFFER_SIZE must be a power of two"
+#endif
+
+//*****************************************************************************
+//
+// The run entries carried by one capture frame, after its flags byte.
+//
+//*****************************************************************************
+#define LOGIC_FRAME_ENTRIES         ((PROTOCOL_MAX_PAYLOAD - 1) / 2)
+
+//*****************************************************************************
+//
+// A value no sample can take, to start the first run.
+//
+//*****************************************************************************
+#define LOGIC_NO_SAMPLE             0xFFFF
+
+//*****************************************************************************
+//
+// The capture ring.  Only the interrupt writes the head and only the main
+// loop writes the tail, as for the rings in ring.c.
+//
+//*****************************************************************************
+#pragma DATA_SECTION(g_pui16LogicBuffer, "DMARAML8");
+static uint16_t g_pui16LogicBuffer[LOGIC_BUFFER_SIZE];
+static volatile uint16_t g_ui16LogicHead = 0;
+static volatile uint16_t g_ui16LogicTail = 0;
+
+//*****************************************************************************
+//
+// The run being counted by the interrupt, and the runs it has had to drop.
+// The main loop reports a loss when the count moves on from the one it last
+// saw, so neither side clears it.
+//
+//*****************************************************************************
+static uint16_t g_ui16LogicValue = LOGIC_NO_SAMPLE;
+static uint16_t g_ui16LogicRun = 0;
+static volatile uint16_t g_ui16LogicLost = 0;
+static uint16_t g_ui16LogicLostSent = 0;
+
+//*****************************************************************************
+//
+// Append the current run to the ring.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(LogicFlush, "ramfuncs");
+static void
+LogicFlush(void)
+{
+    uint16_t ui16Head, ui16Next;
+
+    ui16Head = g_ui16LogicHead;
+    ui16Next = (ui16Head + 1) & (LOGIC_BUFFER_SIZE - 1);
+    if(ui16Next == g_ui16LogicTail)
+    {
+        g_ui16LogicLost++;
+        return;
+    }
+
+    g_pui16LogicBuffer[ui16Head] = ((g_ui16LogicRun - 1) << 8) |
+                                   g_ui16LogicValue;
+    g_ui16LogicHead = ui16Next;
+}
+
+//*****************************************************************************
+//
+// CPU timer 2 interrupt: take one sample.  The bits are gathered in the
+// ReadInput() order: GPIO1, 19, 0, 32, 33, 22, 18 and 12 from bit 7 down.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(LogicSampleISR, "ramfuncs");
+__interrupt void
+LogicSampleISR(void)
+{
+    uint32_t ui32A, ui32B;
+    uint16_t ui16Sample;
+
+    ui32A = GpioDataRegs.GPADAT.all;
+    ui32B = GpioDataRegs.GPBDAT.all;
+
+    ui16Sample = ((uint16_t)(ui32A << 6) & 0x80) |
+                 ((uint16_t)(ui32A >> 13) & 0x40) |
+                 ((uint16_t)(ui32A << 5) & 0x20) |
+                 ((uint16_t)(ui32B << 4) & 0x10) |
+                 ((uint16_t)(ui32B << 2) & 0x08) |
+                 ((uint16_t)(ui32A >> 20) & 0x04) |
+                 ((uint16_t)(ui32A >> 17) & 0x02) |
+                 ((uint16_t)(ui32A >> 12) & 0x01);
+
+    if((ui16Sample == g_ui16LogicValue) && (g_ui16LogicRun < LOGIC_MAX_RUN))
+    {
+        g_ui16LogicRun++;
+        return;
+    }
+
+    if(g_ui16LogicRun)
+    {
+        LogicFlush();
+    }
+    g_ui16LogicValue = ui16Sample;
+    g_ui16LogicRun = 1;
+}
+
+//*****************************************************************************
+//
+// Clock CPU timer 2 and hook up its interrupt, stopped.
+//
+//*****************************************************************************
+void
+LogicInit(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.CPUTIMER2ENCLK = 1;
+    EDIS;
+
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+    CpuTimer2Regs.TCR.bit.TIE = 0;
+
+    IntRegister(INT_TINT2, LogicSampleISR);
+    IntEnable(INT_TINT2);
+}
+
+//*****************************************************************************
+//
+// Start sampling at ui32Rate Hz from an empty ring, stopping any capture
+// already running.
+//
+// \return Returns \b false if the rate is out of range.
+//
+//*****************************************************************************
+tBoolean
+LogicStart(uint32_t ui32Rate)
+{
+    if((ui32Rate < LOGIC_MIN_HZ) || (ui32Rate > LOGIC_MAX_HZ))
+    {
+        return(false);
+    }
+
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+    CpuTimer2Regs.TCR.bit.TIE = 0;
+
+    g_ui16LogicHead = 0;
+    g_ui16LogicTail = 0;
+    g_ui16LogicValue = LOGIC_NO_SAMPLE;
+    g_ui16LogicRun = 0;
+    g_ui16LogicLostSent = g_ui16LogicLost;
+
+    CpuTimer2Regs.PRD.all = (SysCtlClockGet(SYSTEM_CLOCK_SPEED) / ui32Rate) - 1;
+    CpuTimer2Regs.TPR.all = 0;
+    CpuTimer2Regs.TPRH.all = 0;
+    CpuTimer2Regs.TCR.bit.TRB = 1;
+    CpuTimer2Regs.TCR.bit.TIF = 1;
+    CpuTimer2Regs.TCR.bit.TIE = 1;
+    CpuTimer2Regs.TCR.bit.TSS = 0;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Stop sampling.  The run in progress is queued so the host sees the inputs
+// up to the last sample.
+//
+//*****************************************************************************
+void
+LogicStop(void)
+{
+    uint16_t ui16Status;
+
+    CpuTimer2Regs.TCR.bit.TSS = 1;
+    CpuTimer2Regs.TCR.bit.TIE = 0;
+
+    //
+    // An interrupt already pending may still take a sample.
+    //
+    ui16Status = __disable_interrupts();
+    if(g_ui16LogicRun)
+    {
+        LogicFlush();
+        g_ui16LogicRun = 0;
+    }
+    __restore_interrupts(ui16Status);
+}
+
+//*****************************************************************************
+//
+// Send the queued runs to the host, as many frames as the transmit buffer
+// takes.  Room for one more frame is always left so that command responses
+// are not held up behind the capture.
+//
+// A capture frame has ID 0 and carries a flags byte then up to
+// LOGIC_FRAME_ENTRIES runs of two bytes, the sample and the run length less
+// one.
+//
+//*****************************************************************************
+void
+LogicSend(void)
+{
+    tFrameWriter sWriter;
+    uint16_t ui16Tail, ui16Count, ui16Lost;
+
+    while((g_ui16LogicTail != g_ui16LogicHead) &&
+          (USBBufferSpaceAvailable(&g_sTxBuffer) >= 2 * PROTOCOL_MAX_FRAME))
+    {
+        if(!ProtocolBegin(&sWriter, 0, CMD_CAPTURE | PROTOCOL_RESPONSE))
+        {
+            return;
+        }
+
+        ui16Lost = g_ui16LogicLost;
+        ProtocolWrite8(&sWriter, (ui16Lost != g_ui16LogicLostSent) ?
+                                 LOGIC_FLAG_LOST : 0);
+        g_ui16LogicLostSent = ui16Lost;
+
+        ui16Tail = g_ui16LogicTail;
+        for(ui16Count = 0; (ui16Count < LOGIC_FRAME_ENTRIES) &&
+                           (ui16Tail != g_ui16LogicHead); ui16Count++)
+        {
+            ProtocolWrite16(&sWriter, g_pui16LogicBuffer[ui16Tail]);
+            ui16Tail = (ui16Tail + 1) & (LOGIC_BUFFER_SIZE - 1);
+        }
+        g_ui16LogicTail = ui16Tail;
+
+        ProtocolEnd(&sWriter);
+    }
+}
@@ -0,0 +1,52 @@
+//###########################################################################
+//
+// FILE:   logic.h
+//
+// TITLE:  Logic analyser capture of the input pins.
+//
+//###########################################################################
+
+#ifndef __LOGIC_H__
+#define __LOGIC_H__
+
+//*****************************************************************************
+//
+// The sample rates in Hz.  At the highest rate the sampling interrupt takes
+// about a fifth of the CPU.
+//
+//*****************************************************************************
+#define LOGIC_MIN_HZ                1
+#define LOGIC_MAX_HZ                200000
+
+//*****************************************************************************
+//
+// The capture ring, in run entries.  This must be a power of two.
+//
+//*****************************************************************************
+#define LOGIC_BUFFER_SIZE           4096
+
+//*****************************************************************************
+//
+// A run entry holds a sample of the eight inputs, in the ReadInput() bit
+// order, in its low byte and the number of consecutive samples with that
+// value, less one, in its high byte.
+//
+//*****************************************************************************
+#define LOGIC_MAX_RUN               256
+
+//*****************************************************************************
+//
+// Flags in the first byte of a capture frame.
+//
+// LOGIC_FLAG_LOST      samples were dropped before this frame because the
+//                      host did not keep up.
+//
+//*****************************************************************************
+#define LOGIC_FLAG_LOST             0x01
+
+extern void LogicInit(void);
+extern tBoolean LogicStart(uint32_t ui32Rate);
+extern void LogicStop(void);
+extern void LogicSend(void);
+
+#endif // __LOGIC_H__
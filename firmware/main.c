@@ -14,11 +14,9 @@
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
-#include "inc/hw_uart.h"
 #include "driverlib/debug.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
-#include "driverlib/uart.h"
 #include "driverlib/usb.h"
 #include "inc/hw_usb.h"
 #include "usblib/usblib.h"
@@ -27,23 +25,105 @@
 #include "usblib/device/usbdevice.h"
 #include "usblib/device/usbdcdc.h"
 #include "usb_serial_structs.h"
+#include "program_store.h"
+#include "engine.h"
+#include "capture.h"
+#include "analog.h"
+#include "pwm.h"
+#include "pulse.h"
+#include "logic.h"
+#include "pattern.h"
+#include "expansion.h"
+#include "cla.h"
+#include "events.h"
+#include "protocol.h"
+#include "stack.h"
+#include "supervisor.h"
+
+//*****************************************************************************
+//
+// The TI usb_dev_serial UART bridge, which passes CDC data through to SCI-A,
+// is only built when UART_BRIDGE is defined.  Without it SCI-A is left
+// unclocked with its interrupts disabled and the program buffer is larger.
+//
+//*****************************************************************************
+#ifdef UART_BRIDGE
+#include "inc/hw_uart.h"
+#include "driverlib/uart.h"
+#define PROGRAM_BUFFER_SIZE         1024
+#else
+#define PROGRAM_BUFFER_SIZE         4096
+#endif
 
 __interrupt void cpu_timer(void);
+void timer_setup(void);
 void usb_setup(void);
-void spi_setup(void);
 
-//input buffer
-static char USER_PROGRAM[1024] = {0};
+//input buffer, in RAM block L7 as it does not fit in .ebss
+#pragma DATA_SECTION(USER_PROGRAM, "DMARAML7");
+static char USER_PROGRAM[PROGRAM_BUFFER_SIZE];
 static unsigned long read_index = 0;
 int program_recieved = 0;
-int program_compiled = 0;
+int program_compiled = 0;   // 1 if compiled, -1 if the engine rejected it
+int program_saved = 0;      // 1 if stored in flash, -1 if the save failed
+
+//
+// Receive state, owned by the main loop.  The USB interrupt only posts
+// EVENT_USB_RX; the data stays in g_sRxBuffer until ProcessReceived() reads
+// it.
+//
+static tBoolean g_bReceiving = false;
+static tBoolean g_bRxOverflow = false;
+static tBoolean g_bBinary = false;
+static tFrameParser g_sParser;
+
+//
+// Run control and scan statistics.  The program is scanned continuously
+// while g_bRunning is set; the host can stop it and single step it.
+//
+static tBoolean g_bRunning = true;
 
+//
+// Set when the timed tasks are to start once the main loop has saved the
+// program; see StartProgram().
+//
+static tBoolean g_bStartTasks = false;
+uint32_t g_ui32ScanCount = 0;
+uint32_t g_ui32ScanCycles = 0;
+uint32_t g_ui32ScanMaxCycles = 0;
+
+//
+// Values streamed to the host every g_ui16StreamPeriod ms, 0 when off.  Each
+// value is 32 bits in the stream frame.
+//
+#define STREAM_MAX_SLOTS            (PROTOCOL_MAX_PAYLOAD / 4)
+static uint16_t g_pui16StreamSlots[STREAM_MAX_SLOTS];
+static uint16_t g_ui16StreamCount = 0;
+static uint16_t g_ui16StreamPeriod = 0;
+static uint32_t g_ui32StreamLast = 0;
+
+//
+// Duration of the last and the longest USB interrupt, in SYSCLKOUT cycles.
+// This bounds the latency the USB stack adds to every other interrupt.
+//
+uint32_t g_ui32USBIntCycles = 0;
+uint32_t g_ui32USBIntMaxCycles = 0;
+
+//
+// Flash load and run addresses of the ramfuncs section, from the linker.
+//
+extern Uint16 RamfuncsLoadStart;
+extern Uint16 RamfuncsLoadSize;
+extern Uint16 RamfuncsRunStart;
+
+#ifdef UART_BRIDGE
 //*****************************************************************************
 //
 // Flag indicating whether or not a Break condition is currently being sent.
 //
 //*****************************************************************************
 static tBoolean g_bSendingBreak = false;
+#endif
 
 //*****************************************************************************
 //
@@ -58,6 +138,7 @@ __error__(char *pcFilename, uint32_t ui32Line)
 }
 #endif
 
+#ifdef UART_BRIDGE
 //*****************************************************************************
 //
 // This function is called whenever serial data is received from the UART.
@@ -540,6 +621,40 @@ GetLineCoding(tLineCoding *psLineCoding)
     }
 }
 
+#else
+
+//*****************************************************************************
+//
+// Without the bridge the line coding is only kept to report back to the host;
+// it has no effect on the CDC data.
+//
+//*****************************************************************************
+static uint32_t g_ui32LineRate = 9600;
+static uint16_t g_ui16LineStop = USB_CDC_STOP_BITS_1;
+static uint16_t g_ui16LineParity = USB_CDC_PARITY_NONE;
+static uint16_t g_ui16LineDatabits = 8;
+
+static tBoolean
+SetLineCoding(tLineCoding *psLineCoding)
+{
+    g_ui32LineRate = readusb32_t(&(psLineCoding->ui32Rate));
+    g_ui16LineStop = psLineCoding->ui8Stop;
+    g_ui16LineParity = psLineCoding->ui8Parity;
+    g_ui16LineDatabits = psLineCoding->ui8Databits;
+
+    return(true);
+}
+
+static void
+GetLineCoding(tLineCoding *psLineCoding)
+{
+    writeusb32_t(&(psLineCoding->ui32Rate), g_ui32LineRate);
+    psLineCoding->ui8Stop = g_ui16LineStop;
+    psLineCoding->ui8Parity = g_ui16LineParity;
+    psLineCoding->ui8Databits = g_ui16LineDatabits;
+}
+#endif // UART_BRIDGE
+
 //*****************************************************************************
 //
 // This function sets or clears a break condition on the redirected UART RX
@@ -589,10 +704,9 @@ ControlHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
     case USB_EVENT_CONNECTED:
     {
         //
-        // Flush the buffers.
+        // Flush the buffers from the main loop.
         //
-        USBBufferFlush(&g_sTxBuffer);
-        USBBufferFlush(&g_sRxBuffer);
+        EventPost(EVENT_USB_CONNECTED);
 
         break;
     }
@@ -739,9 +853,6 @@ RxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
           void *pvMsgData)
 {
     uint32_t ui32Count;
-    const tUSBDCDCDevice *psCDCDevice;
-    const tUSBBuffer *pBufferRx;
-    const tUSBBuffer *pBufferTx;
 
     //
     // Which event was sent?
@@ -754,49 +865,9 @@ RxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
     case USB_EVENT_RX_AVAILABLE:
     {
         //
-        // Feed some characters into the UART TX FIFO and enable the
-        // interrupt.
+        // Leave the data in the buffer for ProcessReceived().
         //
-        //USBUARTPrimeTransmit();
-        //UARTIntEnable(UART0_BASE, UART_INT_TXRDY);
-    	//unsigned char tempChar = 0xd;
-    	program_recieved = 0;
-        psCDCDevice = (const tUSBDCDCDevice *)pvCBData;
-    	pBufferRx = (const tUSBBuffer *)psCDCDevice->pvRxCBData;
-    	pBufferTx = (const tUSBBuffer *)psCDCDevice->pvTxCBData;
-
-    	read_index = 0;
-    	while(USBBufferRead(pBufferRx, (unsigned char *)&USER_PROGRAM[read_index], 1))
-    	{
-    		read_index++;
-    		if(read_index > 1024){
-
-    			read_index = 0;
-    		}
-    	}
-    	USBBufferFlush(pBufferRx);
-
-    	EALLOW;
-    	GpioDataRegs.GPBCLEAR.bit.GPIO44 = 1;
-    	GpioDataRegs.GPACLEAR.bit.GPIO3 = 1;
-    	GpioDataRegs.GPACLEAR.bit.GPIO16 = 1;
-    	GpioDataRegs.GPACLEAR.bit.GPIO17 = 1;
-    	GpioDataRegs.GPACLEAR.bit.GPIO13 = 1;
-    	GpioDataRegs.GPBCLEAR.bit.GPIO50 = 1;
-    	GpioDataRegs.GPBCLEAR.bit.GPIO51 = 1;
-    	GpioDataRegs.GPBCLEAR.bit.GPIO55 = 1;
-
-    	EDIS;
-    	//int i;
-    	//for(i = 0; i < read_index; i++){
-    	//	while(USBBufferSpaceAvailable(&g_sTxBuffer) < 2){}
-    	//	USBBufferWrite(pBufferTx, &USER_PROGRAM[i], 1);
-    	//}
-    	if(USER_PROGRAM[read_index - 1] == USER_PROGRAM[read_index - 2]){
-    		while(USBBufferSpaceAvailable(&g_sTxBuffer) < 2){}
-    		USBBufferWrite(pBufferTx, "conf", 4);
-    		program_recieved = 1;
-    	}
+        EventPost(EVENT_USB_RX);
 
         break;
     }
@@ -814,7 +885,11 @@ RxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
         // Get the number of bytes in the buffer and add 1 if some data
         // still has to clear the transmitter.
         //
+#ifdef UART_BRIDGE
         ui32Count = UARTBusy(UART0_BASE) ? 1 : 0;
+#else
+        ui32Count = 0;
+#endif
         return(ui32Count);
     }
 
@@ -842,251 +917,804 @@ RxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
     return(0);
 }
 
-void SysCtrlInit(void)
+//*****************************************************************************
+//
+// The USB interrupt.  This wraps the USB library's handler to time it.
+//
+//*****************************************************************************
+__interrupt void
+USBIntHandler(void)
 {
+    uint32_t ui32Start;
 
-    EALLOW;
-    //Disable Watchdog
-    SysCtrlRegs.WDCR = 0x68;
+    ui32Start = CaptureTimeNow();
 
-    //Setup Clock
-    //20MHz ->PLL->80MHz->C28
-    //      ->PLL2->120MHz->USB
-    SysCtrlRegs.CLKCTL.bit.XCLKINOFF = 1;
-    SysCtrlRegs.CLKCTL.bit.XTALOSCOFF = 0;
-    SysCtrlRegs.CLKCTL.bit.OSCCLKSRC2SEL = 0;
-    SysCtrlRegs.CLKCTL.bit.OSCCLKSRCSEL = 1;
+    USB0DeviceIntHandler();
 
-    while(SysCtrlRegs.PLLSTS.bit.MCLKSTS);
-    SysCtrlRegs.PLLSTS.bit.DIVSEL = 0;
-    SysCtrlRegs.PLLSTS.bit.MCLKOFF = 1;
-    SysCtrlRegs.PLLCR.bit.DIV = 4;
-    while(!SysCtrlRegs.PLLSTS.bit.PLLLOCKS);
-    SysCtrlRegs.PLLSTS.bit.MCLKOFF = 1;
-    SysCtrlRegs.PLLSTS.bit.DIVSEL = 3;
+    g_ui32USBIntCycles = CaptureTimeNow() - ui32Start;
+    if(g_ui32USBIntCycles > g_ui32USBIntMaxCycles)
+    {
+        g_ui32USBIntMaxCycles = g_ui32USBIntCycles;
+    }
 
-    SysCtrlRegs.PLL2CTL.bit.PLL2CLKSRCSEL = 2;
-    SysCtrlRegs.PLL2CTL.bit.PLL2EN = 1;
-    SysCtrlRegs.PLL2MULT.bit.PLL2MULT = 6;
-    while(!SysCtrlRegs.PLL2STS.bit.PLL2LOCKS);
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP9;
+}
 
-    //Enable USB Clock
-    SysCtrlRegs.PCLKCR3.bit.USB0ENCLK = 1;
-    //Enable PHY
-    GpioCtrlRegs.GPACTRL2.bit.USB0IOEN = 1;
+//*****************************************************************************
+//
+// Stop the running program and start receiving a new one.
+//
+//*****************************************************************************
+static void
+BeginProgram(void)
+{
+    g_bRxOverflow = false;
+    read_index = 0;
+    program_recieved = 0;
+    program_compiled = 0;
+
+    g_bStartTasks = false;
+    EngineStopTasks();
+    SupervisorSafeOutputs();
+}
 
-    EDIS;
+//*****************************************************************************
+//
+// Compile the received program, if it has not been already.  A program that
+// compiles and is to run has its timed tasks started by StartProgram().
+//
+//*****************************************************************************
+static void
+CompileProgram(void)
+{
+    if(program_recieved && !program_compiled)
+    {
+        program_compiled = EngineLoad(USER_PROGRAM, read_index) ? 1 : -1;
+        g_bStartTasks = (program_compiled == 1) && g_bRunning;
+    }
 }
 
-int HexConstant(int value){
+//*****************************************************************************
+//
+// Save a newly compiled program to flash, then start its timed tasks.  The
+// save holds interrupts off for the whole erase/program cycle, so it is done
+// from the main loop once the command that compiled the program has been
+// answered, and before the tasks start so that it does not stall them.
+//
+//*****************************************************************************
+static void
+StartProgram(void)
+{
+    if(program_compiled != 1)
+    {
+        return;
+    }
+
+    if(!program_saved)
+    {
+        program_saved = ProgramStoreSave(USER_PROGRAM, read_index) ? 1 : -1;
+    }
 
-    return value;
+    if(g_bStartTasks)
+    {
+        g_bStartTasks = false;
+        EngineStartTasks();
+    }
 }
 
-int SetOutput(int inputBits){
-	if (inputBits & 1){
-		EALLOW;
-		GpioDataRegs.GPBSET.bit.GPIO44 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPBCLEAR.bit.GPIO44 = 1;
-		EDIS;
-	}
-	if (inputBits & 2){
-		EALLOW;
-		GpioDataRegs.GPASET.bit.GPIO3 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPACLEAR.bit.GPIO3 = 1;
-		EDIS;
-	}
-	if (inputBits & 4){
-		EALLOW;
-		GpioDataRegs.GPASET.bit.GPIO16 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPACLEAR.bit.GPIO16 = 1;
-		EDIS;
-	}
-	if (inputBits & 8){
-		EALLOW;
-		GpioDataRegs.GPASET.bit.GPIO17 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPACLEAR.bit.GPIO17 = 1;
-		EDIS;
-	}
-	if (inputBits & 16){
-		EALLOW;
-		GpioDataRegs.GPASET.bit.GPIO13 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPACLEAR.bit.GPIO13 = 1;
-		EDIS;
-	}
-	if (inputBits & 32){
-		EALLOW;
-		GpioDataRegs.GPBSET.bit.GPIO50 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPBCLEAR.bit.GPIO50 = 1;
-		EDIS;
-	}
-	if (inputBits & 64){
-		EALLOW;
-		GpioDataRegs.GPBSET.bit.GPIO51 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPBCLEAR.bit.GPIO51 = 1;
-		EDIS;
-	}
-	if (inputBits & 128){
-		EALLOW;
-		GpioDataRegs.GPBSET.bit.GPIO55 = 1;
-		EDIS;
-	}
-	else{
-		EALLOW;
-		GpioDataRegs.GPBCLEAR.bit.GPIO55 = 1;
-		EDIS;
-	}
+//*****************************************************************************
+//
+// Run one scan of the compiled program under the supervisor and time it.
+//
+//*****************************************************************************
+static void
+ScanProgram(void)
+{
+    uint32_t ui32Start;
 
-	return inputBits;
-}
-int ReadInput(){
-
-	int outputBits = 0;
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO1) << 7);
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO19) << 6);
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO0) << 5);
-	outputBits |= ((GpioDataRegs.GPBDAT.bit.GPIO32) << 4);
-	outputBits |= ((GpioDataRegs.GPBDAT.bit.GPIO33) << 3);
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO22) << 2);
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO18) << 1);
-	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO12));
-
-	return outputBits;
-}
+    ui32Start = CaptureTimeNow();
 
-int OctalShiftLeft(int inputBits){
+    SupervisorScanBegin();
+    CaptureUpdate();
+    ExpansionUpdate();
+    EngineScan();
+    ExpansionFlush();
+    SupervisorScanEnd();
 
-    int outputBits = inputBits << 1;
-    return outputBits;
+    g_ui32ScanCycles = CaptureTimeNow() - ui32Start;
+    if(g_ui32ScanCycles > g_ui32ScanMaxCycles)
+    {
+        g_ui32ScanMaxCycles = g_ui32ScanCycles;
+    }
+    g_ui32ScanCount++;
 }
 
-int OctalShiftRight(int inputBits){
+//*****************************************************************************
+//
+// EVENT_USB_CONNECTED: start the new session with empty buffers.
+//
+//*****************************************************************************
+static void
+ProcessConnected(void)
+{
+    USBBufferFlush(&g_sTxBuffer);
+    USBBufferFlush(&g_sRxBuffer);
 
-    int outputBits = inputBits >> 1;
-    return outputBits;
+    g_bReceiving = false;
+    g_bBinary = false;
+    g_ui16StreamPeriod = 0;
 }
 
-int OctalAND(int inputA, int inputB){
+//*****************************************************************************
+//
+// EVENT_USB_REPLY: confirm a received program to the host.  If the transmit
+// buffer is full the reply is posted again and retried on the next pass
+// rather than waiting for it here.
+//
+//*****************************************************************************
+static void
+ProcessReply(void)
+{
+    if(USBBufferSpaceAvailable(&g_sTxBuffer) < 4)
+    {
+        EventPost(EVENT_USB_REPLY);
+        return;
+    }
 
-    int outputBits = inputA & inputB;
-    return outputBits;
+    USBBufferWrite(&g_sTxBuffer, "conf", 4);
 }
 
+//*****************************************************************************
+//
+// EVENT_FAULT: tell a binary protocol host that the supervisor has put the
+// outputs in the safe state.  The frame is retried on the next pass if the
+// transmit buffer is full.
+//
+//*****************************************************************************
+static void
+ProcessFault(void)
+{
+    tFrameWriter sWriter;
 
-void main(void) {
-	//
-	    // Set the clocking to run from the PLL
-	    //
-	    SysCtrlInit();
+    if(!g_bBinary)
+    {
+        return;
+    }
 
-	    InitPieCtrl();
-	    InitPieVectTable();
+    if(!ProtocolBegin(&sWriter, 0, CMD_FAULT | PROTOCOL_RESPONSE))
+    {
+        EventPost(EVENT_FAULT);
+        return;
+    }
 
+    ProtocolWrite8(&sWriter, STATUS_OK);
+    ProtocolWrite16(&sWriter, g_ui16SupervisorFaults);
+    ProtocolWrite16(&sWriter, g_ui16SupervisorOverruns);
+    ProtocolWrite8(&sWriter, SupervisorGetSafeState());
+    ProtocolEnd(&sWriter);
+}
 
-	    //
-	    // Enable Device Mode
-	    //
-	    EALLOW;
-	    HWREG(USBMODESEL) = USBMODESEL_DEV;
-	    HWREG(USB0_BASE + USB_O_GPCS) = USBGPCS_DEV;
-	    EDIS;
+//*****************************************************************************
+//
+// Tell the host that pattern playback has moved on to its queued buffer,
+// freeing the other for loading, or has stopped at the end of its last one.
+// The frame is retried on the next pass if the transmit buffer is full.
+//
+//*****************************************************************************
+static void
+ProcessPattern(void)
+{
+    tFrameWriter sWriter;
 
-	    //
-	    // Enable the UART.
-	    //
-	    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    if(!g_bBinary)
+    {
+        return;
+    }
 
-	    //
-	    // Enable and configure the UART RX and TX pins
-	    //
-	    EALLOW;
-	    GpioCtrlRegs.GPAMUX2.bit.GPIO28 = 1;
-	    GpioCtrlRegs.GPAPUD.bit.GPIO28 = 0;
-	    GpioCtrlRegs.GPAQSEL2.bit.GPIO28 = 3;
-	    GpioCtrlRegs.GPADIR.bit.GPIO28 = 0;
+    if(!ProtocolBegin(&sWriter, 0, CMD_PATTERN_QUEUE | PROTOCOL_RESPONSE))
+    {
+        EventPost(EVENT_PATTERN);
+        return;
+    }
 
-	    GpioCtrlRegs.GPAMUX2.bit.GPIO29 = 1;
-	    GpioCtrlRegs.GPAPUD.bit.GPIO29 = 0;
-	    GpioCtrlRegs.GPADIR.bit.GPIO29 = 1;
-	    EDIS;
+    ProtocolWrite8(&sWriter, STATUS_OK);
+    ProtocolWrite8(&sWriter, PatternState());
+    ProtocolEnd(&sWriter);
+}
 
-	    //
-	    // Register interrupt handlers
-	    //
-	    IntRegister(INT_SCITXINTA, USBUARTTXIntHandler);
-	    IntRegister(INT_SCIRXINTA, USBUARTRXIntHandler);
+//*****************************************************************************
+//
+// Carry out one command frame from the host and send its response.
+//
+//*****************************************************************************
+static void
+ProcessCommand(const tFrame *psFrame)
+{
+    unsigned char pucResponse[PROTOCOL_MAX_PAYLOAD];
+    uint16_t ui16Length, ui16Offset, ui16Slot, ui16Index;
+    tEngineUsage sUsage;
+    int32_t i32Value;
+    uint32_t ui32Rate;
 
-	    //
-	    // Configure the required pins for USB operation.
-	    //
-	    USBGPIOEnable();
-	    USBIntRegister(USB0_BASE, f28x_USB0DeviceIntHandler);
+    pucResponse[0] = STATUS_OK;
+    ui16Length = 1;
 
-	    //
-	    // Set the default UART configuration.
-	    //
-	    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(SYSTEM_CLOCK_SPEED)/4, 9600,
-	                        UART_CONFIG_WLEN_8 | UART_CONFIG_PAR_NONE |
-	                        UART_CONFIG_STOP_ONE);
-	    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    switch(psFrame->ui16Command)
+    {
+    case CMD_PING:
+    {
+        break;
+    }
 
-	    //
-	    // Configure and enable UART interrupts.
-	    //
-	    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, false));
-	    UARTIntEnable(UART0_BASE, (UART_INT_RXERR | UART_INT_RXRDY_BRKDT | UART_INT_TXRDY ));
+    //
+    // Program chunks must arrive in order.  Offset 0 stops the running
+    // program and starts a new one.
+    //
+    case CMD_UPLOAD:
+    {
+        if(psFrame->ui16Length < 2)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
 
-	    //
-	    // Initialize the transmit and receive buffers.
-	    //
-	    USBBufferInit(&g_sTxBuffer);
-	    USBBufferInit(&g_sRxBuffer);
+        ui16Offset = ProtocolGet16(psFrame->pucPayload);
+        if(ui16Offset == 0)
+        {
+            BeginProgram();
+        }
+        else if(ui16Offset != read_index)
+        {
+            pucResponse[0] = STATUS_BAD_ARGUMENT;
+            break;
+        }
 
-	    //
-	    // Set the USB stack mode to Device mode with VBUS monitoring.
-	    //
-	    USBStackModeSet(0, eUSBModeForceDevice, 0);
+        if(read_index + psFrame->ui16Length - 2 > sizeof(USER_PROGRAM))
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        for(ui16Index = 2; ui16Index < psFrame->ui16Length; ui16Index++)
+        {
+            USER_PROGRAM[read_index++] = psFrame->pucPayload[ui16Index];
+        }
+        break;
+    }
+
+    //
+    // Compile what has been uploaded, if anything, and run it.
+    //
+    case CMD_RUN:
+    {
+        if(read_index && !program_recieved)
+        {
+            program_recieved = 1;
+            program_saved = 0;
+        }
+        CompileProgram();
+
+        if(program_compiled != 1)
+        {
+            pucResponse[0] = STATUS_REJECTED;
+            break;
+        }
+        SupervisorClearFaults();
+        g_bRunning = true;
+        g_bStartTasks = true;
+        break;
+    }
+
+    case CMD_STOP:
+    {
+        g_bRunning = false;
+        g_bStartTasks = false;
+        EngineStopTasks();
+        SupervisorSafeOutputs();
+        ExpansionSafeOutputs();
+        break;
+    }
+
+    case CMD_STEP:
+    {
+        if((program_compiled != 1) || g_ui16SupervisorFaults)
+        {
+            pucResponse[0] = STATUS_REJECTED;
+            break;
+        }
+        //
+        // One step runs every timed task once, then the background task.
+        //
+        g_bRunning = false;
+        g_bStartTasks = false;
+        EngineStopTasks();
+        EngineStepTasks();
+        ScanProgram();
+        break;
+    }
+
+    case CMD_READ_VALUE:
+    {
+        if(psFrame->ui16Length != 2)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        ui16Slot = ProtocolGet16(psFrame->pucPayload);
+        if(!EngineReadValue(ui16Slot, &i32Value))
+        {
+            pucResponse[0] = STATUS_BAD_ARGUMENT;
+            break;
+        }
+        ProtocolPut32(&pucResponse[1], (uint32_t)i32Value);
+        ui16Length = 5;
+        break;
+    }
+
+    case CMD_WRITE_VALUE:
+    {
+        if(psFrame->ui16Length != 6)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        ui16Slot = ProtocolGet16(psFrame->pucPayload);
+        i32Value = (int32_t)ProtocolGet32(&psFrame->pucPayload[2]);
+        if(!EngineWriteValue(ui16Slot, i32Value))
+        {
+            pucResponse[0] = STATUS_BAD_ARGUMENT;
+        }
+        break;
+    }
+
+    case CMD_STATS:
+    {
+        ProtocolPut32(&pucResponse[1], g_ui32ScanCount);
+        ProtocolPut32(&pucResponse[5], g_ui32ScanCycles);
+        ProtocolPut32(&pucResponse[9], g_ui32ScanMaxCycles);
+        ProtocolPut32(&pucResponse[13], g_ui32USBIntMaxCycles);
+        ProtocolPut16(&pucResponse[17], g_ui16CaptureOverflows);
+        ProtocolPut16(&pucResponse[19], (uint16_t)read_index);
+        pucResponse[21] = (program_compiled == 1) ? 1 : 0;
+        pucResponse[22] = g_bRunning ? 1 : 0;
+        pucResponse[23] = (program_saved == 1) ? STORE_SAVED :
+                          (program_saved < 0) ? STORE_FAILED : STORE_PENDING;
+        ui16Length = 24;
+        break;
+    }
+
+    //
+    // A period of 0 turns streaming off.
+    //
+    case CMD_STREAM:
+    {
+        if((psFrame->ui16Length < 2) || (psFrame->ui16Length & 1) ||
+           (psFrame->ui16Length > 2 + (STREAM_MAX_SLOTS * 2)))
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        g_ui16StreamPeriod = ProtocolGet16(psFrame->pucPayload);
+        g_ui16StreamCount = (psFrame->ui16Length - 2) / 2;
+        g_ui32StreamLast = EngineTime();
+        for(ui16Index = 0; ui16Index < g_ui16StreamCount; ui16Index++)
+        {
+            g_pui16StreamSlots[ui16Index] =
+                ProtocolGet16(&psFrame->pucPayload[2 + (ui16Index * 2)]);
+        }
+        break;
+    }
+
+    //
+    // Stack high-water mark, program store fill and table use, each followed
+    // by its capacity.
+    //
+    case CMD_MEMORY:
+    {
+        EngineUsage(&sUsage);
+        ProtocolPut16(&pucResponse[1], StackHighWater());
+        ProtocolPut16(&pucResponse[3], StackSize());
+        ProtocolPut32(&pucResponse[5], ProgramStoreUsed());
+        ProtocolPut32(&pucResponse[9], PROGRAM_STORE_SIZE);
+        ProtocolPut16(&pucResponse[13], (uint16_t)read_index);
+        ProtocolPut16(&pucResponse[15], sizeof(USER_PROGRAM));
+        ProtocolPut16(&pucResponse[17], sUsage.ui16Instructions);
+        ProtocolPut16(&pucResponse[19], ENGINE_MAX_INSTRUCTIONS);
+        ProtocolPut16(&pucResponse[21], sUsage.ui16Operands);
+        ProtocolPut16(&pucResponse[23], ENGINE_MAX_OPERANDS);
+        ProtocolPut16(&pucResponse[25], sUsage.ui16Constants);
+        ProtocolPut16(&pucResponse[27], ENGINE_MAX_CONSTANTS);
+        ProtocolPut16(&pucResponse[29], sUsage.ui16States);
+        ProtocolPut16(&pucResponse[31], ENGINE_MAX_STATES);
+        ui16Length = 33;
+        break;
+    }
+
+    case CMD_FAULT:
+    {
+        ProtocolPut16(&pucResponse[1], g_ui16SupervisorFaults);
+        ProtocolPut16(&pucResponse[3], g_ui16SupervisorOverruns);
+        pucResponse[5] = SupervisorGetSafeState();
+        ui16Length = 6;
+        break;
+    }
+
+    //
+    // Takes effect at once if the outputs are already in the safe state.
+    //
+    case CMD_SAFE_STATE:
+    {
+        if(psFrame->ui16Length != 1)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        SupervisorSetSafeState(psFrame->pucPayload[0]);
+        if((program_compiled != 1) || g_ui16SupervisorFaults)
+        {
+            SupervisorSafeOutputs();
+        }
+        break;
+    }
+
+    //
+    // A rate of 0 stops the capture.
+    //
+    case CMD_CAPTURE:
+    {
+        if(psFrame->ui16Length != 4)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        ui32Rate = ProtocolGet32(psFrame->pucPayload);
+        if(ui32Rate == 0)
+        {
+            LogicStop();
+        }
+        else if(!LogicStart(ui32Rate))
+        {
+            pucResponse[0] = STATUS_BAD_ARGUMENT;
+        }
+        break;
+    }
+
+    //
+    // Pattern words go into the buffer that is not playing.
+    //
+    case CMD_PATTERN_LOAD:
+    {
+        if(psFrame->ui16Length < 2)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        if(!PatternLoad(ProtocolGet16(psFrame->pucPayload),
+                        &psFrame->pucPayload[2], psFrame->ui16Length - 2))
+        {
+            pucResponse[0] = STATUS_BAD_ARGUMENT;
+        }
+        break;
+    }
+
+    case CMD_PATTERN_QUEUE:
+    {
+        if(psFrame->ui16Length != 2)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        if(!PatternQueue(ProtocolGet16(psFrame->pucPayload)))
+        {
+            pucResponse[0] = STATUS_REJECTED;
+        }
+        pucResponse[1] = PatternState();
+        ui16Length = 2;
+        break;
+    }
+
+    //
+    // A rate of 0 stops the playback and hands the outputs back.
+    //
+    case CMD_PATTERN_PLAY:
+    {
+        if(psFrame->ui16Length != 6)
+        {
+            pucResponse[0] = STATUS_BAD_LENGTH;
+            break;
+        }
+
+        ui32Rate = ProtocolGet32(psFrame->pucPayload);
+        if(ui32Rate == 0)
+        {
+            PatternStop();
+        }
+        else if(!PatternStart(ui32Rate, psFrame->pucPayload[4],
+                              psFrame->pucPayload[5]))
+        {
+            pucResponse[0] = STATUS_REJECTED;
+        }
+        pucResponse[1] = PatternState();
+        ui16Length = 2;
+        break;
+    }
+
+    default:
+    {
+        pucResponse[0] = STATUS_BAD_COMMAND;
+        break;
+    }
+    }
+
+    ProtocolSend(psFrame->ui16ID, psFrame->ui16Command | PROTOCOL_RESPONSE,
+                 pucResponse, ui16Length);
+}
+
+//*****************************************************************************
+//
+// Send the streamed values once their period has passed.  The frame is built
+// in place in the transmit buffer; a sample is skipped rather than waited for
+// if the buffer is full.
+//
+//*****************************************************************************
+static void
+StreamValues(void)
+{
+    tFrameWriter sWriter;
+    uint16_t ui16Index;
+    int32_t i32Value;
+
+    if((g_ui16StreamPeriod == 0) ||
+       (EngineTime() - g_ui32StreamLast < g_ui16StreamPeriod))
+    {
+        return;
+    }
+    g_ui32StreamLast = EngineTime();
+
+    if(!ProtocolBegin(&sWriter, 0, CMD_STREAM | PROTOCOL_RESPONSE))
+    {
+        return;
+    }
+
+    for(ui16Index = 0; ui16Index < g_ui16StreamCount; ui16Index++)
+    {
+        i32Value = 0;
+        EngineReadValue(g_pui16StreamSlots[ui16Index], &i32Value);
+        ProtocolWrite32(&sWriter, (uint32_t)i32Value);
+    }
+
+    ProtocolEnd(&sWriter);
+}
+
+//*****************************************************************************
+//
+// EVENT_USB_RX: read what the host has sent.
+//
+// A sync byte at the start of a message selects the binary command protocol
+// for the session; anything else is a UPL text upload, kept for older hosts.
+// Reading stops while the transmit buffer could not take a full response, so
+// every command is answered, and resumes on a later pass.
+//
+// For a text upload the first character after a complete program starts a
+// new one, at which point the running program is stopped and the outputs are
+// made safe.  A program is complete at "##", when it is confirmed to the host
+// and handed to the main loop to compile.
+//
+//*****************************************************************************
+static void
+ProcessReceived(void)
+{
+    unsigned char pucChunk[PROTOCOL_OVERHEAD];
+    uint32_t ui32Count, ui32Char;
+    char cChar;
+
+    while(USBBufferSpaceAvailable(&g_sTxBuffer) >= PROTOCOL_MAX_FRAME)
+    {
+        //
+        // A chunk no longer than the shortest frame completes at most one
+        // command.
+        //
+        ui32Count = USBBufferRead(&g_sRxBuffer, pucChunk, sizeof(pucChunk));
+        if(ui32Count == 0)
+        {
+            return;
+        }
+
+        for(ui32Char = 0; ui32Char < ui32Count; ui32Char++)
+        {
+            cChar = pucChunk[ui32Char];
+
+            if(!g_bReceiving && !g_bBinary)
+            {
+                if(cChar == PROTOCOL_SYNC)
+                {
+                    g_bBinary = true;
+                    ProtocolReset(&g_sParser);
+                }
+                else
+                {
+                    g_bReceiving = true;
+                    BeginProgram();
+                }
+            }
+
+            if(g_bBinary)
+            {
+                if(ProtocolParse(&g_sParser, cChar))
+                {
+                    ProcessCommand(&g_sParser.sFrame);
+                }
+                continue;
+            }
+
+            if(read_index < sizeof(USER_PROGRAM))
+            {
+                USER_PROGRAM[read_index++] = cChar;
+            }
+            else
+            {
+                g_bRxOverflow = true;
+            }
+
+            //
+            // "##" ends the program.
+            //
+            if((cChar == '#') && (read_index >= 2) &&
+               (USER_PROGRAM[read_index - 2] == '#'))
+            {
+                g_bReceiving = false;
+                program_recieved = 1;
+                g_bRunning = true;
+
+                if(g_bRxOverflow)
+                {
+                    program_compiled = -1;
+                }
+                else
+                {
+                    program_saved = 0;
+                    EventPost(EVENT_USB_REPLY);
+                }
+            }
+        }
+    }
+
+    //
+    // Come back for the rest once there is room to answer it.
+    //
+    if(USBBufferDataAvailable(&g_sRxBuffer))
+    {
+        EventPost(EVENT_USB_RX);
+    }
+}
+
+//*****************************************************************************
+//
+// CPU timer 0 interrupt, the 1 ms scan timebase used by timer tiles.  It also
+// releases the timed tasks and runs those due, which may take longer than a
+// tick; the next tick then nests inside this one.
+//
+//*****************************************************************************
+__interrupt void
+cpu_timer(void)
+{
+    EngineTick();
+    SupervisorTick();
 
+    if(!g_ui16SupervisorFaults && !EngineRelease())
+    {
+        SupervisorOverrun();
+    }
+
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP1;
+
+    if(!g_ui16SupervisorFaults)
+    {
+        EngineDispatch();
+    }
+}
+
+//*****************************************************************************
+//
+// Run CPU timer 0 at ENGINE_TICK_HZ from SYSCLKOUT.
+//
+//*****************************************************************************
+void timer_setup(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR3.bit.CPUTIMER0ENCLK = 1;
+    EDIS;
+
+    CpuTimer0Regs.TCR.bit.TSS = 1;
+    CpuTimer0Regs.PRD.all = (SysCtlClockGet(SYSTEM_CLOCK_SPEED) /
+                             ENGINE_TICK_HZ) - 1;
+    CpuTimer0Regs.TPR.all = 0;
+    CpuTimer0Regs.TPRH.all = 0;
+    CpuTimer0Regs.TCR.bit.TRB = 1;
+    CpuTimer0Regs.TCR.bit.TIF = 1;
+    CpuTimer0Regs.TCR.bit.TIE = 1;
+
+    IntRegister(INT_TINT0, cpu_timer);
+    IntEnable(INT_TINT0);
+
+    CpuTimer0Regs.TCR.bit.TSS = 0;
+}
+
+void SysCtrlInit(void)
+{
+
+    EALLOW;
+    //Disable Watchdog until SupervisorStart()
+    SysCtrlRegs.WDCR = SUPERVISOR_WDCR_DISABLE;
+
+    //Setup Clock
+    //20MHz ->PLL->80MHz->C28
+    //      ->PLL2->120MHz->USB
+    SysCtrlRegs.CLKCTL.bit.XCLKINOFF = 1;
+    SysCtrlRegs.CLKCTL.bit.XTALOSCOFF = 0;
+    SysCtrlRegs.CLKCTL.bit.OSCCLKSRC2SEL = 0;
+    SysCtrlRegs.CLKCTL.bit.OSCCLKSRCSEL = 1;
+
+    while(SysCtrlRegs.PLLSTS.bit.MCLKSTS);
+    SysCtrlRegs.PLLSTS.bit.DIVSEL = 0;
+    SysCtrlRegs.PLLSTS.bit.MCLKOFF = 1;
+    SysCtrlRegs.PLLCR.bit.DIV = 4;
+    while(!SysCtrlRegs.PLLSTS.bit.PLLLOCKS);
+    SysCtrlRegs.PLLSTS.bit.MCLKOFF = 1;
+    SysCtrlRegs.PLLSTS.bit.DIVSEL = 3;
+
+    SysCtrlRegs.PLL2CTL.bit.PLL2CLKSRCSEL = 2;
+    SysCtrlRegs.PLL2CTL.bit.PLL2EN = 1;
+    SysCtrlRegs.PLL2MULT.bit.PLL2MULT = 6;
+    while(!SysCtrlRegs.PLL2STS.bit.PLL2LOCKS);
+
+    //Enable USB Clock
+    SysCtrlRegs.PCLKCR3.bit.USB0ENCLK = 1;
+    //Enable PHY
+    GpioCtrlRegs.GPACTRL2.bit.USB0IOEN = 1;
+
+    EDIS;
+}
+
+void main(void) {
 	    //
-	    // Pass the device information to the USB library and place the device
-	    // on the bus.
+	    // Mark the unused stack so its high-water mark can be read back.
 	    //
-	    USBDCDCInit(0, &g_sCDCDevice);
+	    StackPaint();
 
 	    //
-	    // Enable interrupts now that the application is ready to start.
+	    // Pick up a watchdog reset before the watchdog is reconfigured.
 	    //
-	    IntEnable(INT_SCITXINTA);
-	    IntEnable(INT_SCIRXINTA);
+	    SupervisorInit();
+
+	//
+	    // Set the clocking to run from the PLL
+	    //
+	    SysCtrlInit();
+
+	    //
+	    // Copy the flash programming routines to RAM.
+	    //
+	    memcpy(&RamfuncsRunStart, &RamfuncsLoadStart, (size_t)&RamfuncsLoadSize);
+
+	    //
+	    // Load the CLA program before any user program can use it.
+	    //
+	    ClaInit();
+
+	    InitPieCtrl();
+	    InitPieVectTable();
 
+	    //
+	    // Configure the outputs before anything can drive them.
+	    //
 	    EALLOW;
 	    GpioCtrlRegs.GPBMUX1.bit.GPIO44 = 0;
 	    GpioCtrlRegs.GPBDIR.bit.GPIO44 = 1;
@@ -1122,142 +1750,195 @@ void main(void) {
 
 	    EDIS;
 
-	    IntMasterEnable();
+	    //
+	    // Run the program stored in flash, if there is one, without waiting for
+	    // the host to enumerate us.
+	    //
+	    read_index = ProgramStoreLoad(USER_PROGRAM, sizeof(USER_PROGRAM));
+	    if(read_index)
+	    {
+	        program_saved = 1;
+	        program_recieved = 1;
+	        program_compiled = EngineLoad(USER_PROGRAM, read_index) ? 1 : -1;
+	        if(program_compiled == 1)
+	        {
+	            EngineStartTasks();
+	        }
+	    }
+
 
 	    //
-	    // Main application loop.
+	    // Enable Device Mode
+	    //
+	    EALLOW;
+	    HWREG(USBMODESEL) = USBMODESEL_DEV;
+	    HWREG(USB0_BASE + USB_O_GPCS) = USBGPCS_DEV;
+	    EDIS;
+
+#ifdef UART_BRIDGE
+	    //
+	    // Enable the UART.
+	    //
+	    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+
+	    //
+	    // Enable and configure the UART RX and TX pins
+	    //
+	    EALLOW;
+	    GpioCtrlRegs.GPAMUX2.bit.GPIO28 = 1;
+	    GpioCtrlRegs.GPAPUD.bit.GPIO28 = 0;
+	    GpioCtrlRegs.GPAQSEL2.bit.GPIO28 = 3;
+	    GpioCtrlRegs.GPADIR.bit.GPIO28 = 0;
+
+	    GpioCtrlRegs.GPAMUX2.bit.GPIO29 = 1;
+	    GpioCtrlRegs.GPAPUD.bit.GPIO29 = 0;
+	    GpioCtrlRegs.GPADIR.bit.GPIO29 = 1;
+	    EDIS;
+
+	    //
+	    // Register interrupt handlers
 	    //
+	    IntRegister(INT_SCITXINTA, USBUARTTXIntHandler);
+	    IntRegister(INT_SCIRXINTA, USBUARTRXIntHandler);
+#endif
+
+	    //
+	    // Configure the required pins for USB operation.
+	    //
+	    USBGPIOEnable();
+	    USBIntRegister(USB0_BASE, USBIntHandler);
 
-	    int outputs[1024];
-	    int tile_index = 1;
-	    char function[7];
-	    function[6] = '\0'; // There was an error here... index of 7 instead of 6
-	    int inputs[64];
-	    char input_types[64];
+	    //
+	    // USB work is done from the main loop, not the interrupt.
+	    //
+	    EventRegister(EVENT_USB_CONNECTED, ProcessConnected);
+	    EventRegister(EVENT_USB_RX, ProcessReceived);
+	    EventRegister(EVENT_USB_REPLY, ProcessReply);
+	    EventRegister(EVENT_FAULT, ProcessFault);
+	    EventRegister(EVENT_PATTERN, ProcessPattern);
 
-	    // To hold counters
-	    int k = 0;
-	    int f = 0;
-	    int input_counter = 0;
+#ifdef UART_BRIDGE
+	    //
+	    // Set the default UART configuration.
+	    //
+	    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(SYSTEM_CLOCK_SPEED)/4, 9600,
+	                        UART_CONFIG_WLEN_8 | UART_CONFIG_PAR_NONE |
+	                        UART_CONFIG_STOP_ONE);
+	    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+
+	    //
+	    // Configure and enable UART interrupts.
+	    //
+	    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, false));
+	    UARTIntEnable(UART0_BASE, (UART_INT_RXERR | UART_INT_RXRDY_BRKDT | UART_INT_TXRDY ));
+
+#endif
+
+	    //
+	    // Initialize the transmit and receive buffers.
+	    //
+	    USBBufferInit(&g_sTxBuffer);
+	    USBBufferInit(&g_sRxBuffer);
+
+	    //
+	    // Set the USB stack mode to Device mode with VBUS monitoring.
+	    //
+	    USBStackModeSet(0, eUSBModeForceDevice, 0);
+
+	    //
+	    // Pass the device information to the USB library and place the device
+	    // on the bus.
+	    //
+	    USBDCDCInit(0, &g_sCDCDevice);
+
+	    //
+	    // Enable interrupts now that the application is ready to start.
+	    //
+#ifdef UART_BRIDGE
+	    IntEnable(INT_SCITXINTA);
+	    IntEnable(INT_SCIRXINTA);
+#endif
+
+	    //
+	    // Start the scan timebase.
+	    //
+	    timer_setup();
+
+	    //
+	    // Catch edges on the fast inputs between scans.
+	    //
+	    CaptureInit();
+
+	    //
+	    // Sample the analog inputs in the background.
+	    //
+	    AnalogInit();
+
+	    //
+	    // Clock the ePWMs behind the PWM output tiles.
+	    //
+	    PwmInit();
+
+	    //
+	    // Time and count the fast pulse inputs in hardware.
+	    //
+	    PulseInit();
+
+	    //
+	    // Ready the logic analyser, which starts on the host's command.
+	    //
+	    LogicInit();
+
+	    //
+	    // Ready the pattern playback, which also waits for the host.
+	    //
+	    PatternInit();
+
+	    //
+	    // Take the SPI bus to the add-on boards, with their outputs off.
+	    //
+	    ExpansionInit();
+
+	    IntMasterEnable();
+
+	    //
+	    // From here every pass of the main loop services the watchdog.
+	    //
+	    SupervisorStart();
+
+	    //
+	    // Main application loop.
+	    //
 
 	while(1){
-		if(program_recieved){
-
-			while(k < read_index){
-				//if(GpioDataRegs.GPADAT.bit.GPIO1 || GpioDataRegs.GPADAT.bit.GPIO12){
-				//	EALLOW;
-				//	GpioDataRegs.GPBSET.bit.GPIO55 = 1;
-				//	EDIS;
-				//}
-				if(f < 6){
-					function[f] = USER_PROGRAM[k];
-			        f++;
-			    }
-
-			    // relative input
-			    if(USER_PROGRAM[k] == 'i' && USER_PROGRAM[k + 1] == 'o'){
-			    	inputs[input_counter] = USER_PROGRAM[k + 2] - '0';
-			        input_types[input_counter] = 'r';
-			        input_counter++;
-			        k += 3;
-			    }
-
-			    //absolute input
-			    else if(USER_PROGRAM[k] == 'i' && USER_PROGRAM[k + 1] != 'o'){
-			    	k++;
-			        char temp[32] = {0};
-			        int temp_i = 0;
-			        while(USER_PROGRAM[k] != 'i' && USER_PROGRAM[k] != 'o'){
-			        	temp[temp_i] = USER_PROGRAM[k];
-			            temp_i++;
-			            k++;
-			        }
-			        char *p;
-			        input_types[input_counter] = 'a';
-			        inputs[input_counter] = strtoul(temp, &p, 16);
-			    }
-
-			    // output
-			    else if(USER_PROGRAM[k] == 'o'){
-			    	tile_index = USER_PROGRAM[k+1] - '0';
-			        k++;
-			    }
-
-			    // End of function call
-			    else if(USER_PROGRAM[k] == '#'){
-
-					// get inputs in order
-					int prepared_inputs[64];
-					int n = 0;
-
-					// preparing the inputs
-					do{
-						if(input_types[n] == 'a'){
-							prepared_inputs[n] = inputs[n];
-						}
-						else if(input_types[n] == 'r'){
-							prepared_inputs[n] = outputs[inputs[n]];
-						}
-						n++;
-					}while(n < input_counter);
-
-					// Select the correct Function and Run
-					if(strcmp(function, "0xA001") == 0){
-						outputs[tile_index] = HexConstant(prepared_inputs[0]);
-						//printf("0xA001 Output: %d\n", outputs[tile_index]);
-					}
-					if(strcmp(function, "0x4000") == 0){
-						outputs[tile_index] = SetOutput(prepared_inputs[0]);
-						//printf("0xA001 Output: %d\n", outputs[tile_index]);
-					}
-	                else if(strcmp("0x2000", function) == 0){
-	                    outputs[tile_index] = ReadInput();
-	                    //printf("0x2000 Output: %d\n", outputs[tile_index]);
-	                }
-					else if(strcmp("0x8001", function) == 0){
-						outputs[tile_index] = OctalShiftLeft(prepared_inputs[0]);
-						//printf("0x8001 Output: %d\n", outputs[tile_index]);
-					}
-					else if(strcmp("0x8002", function) == 0){
-						outputs[tile_index] = OctalShiftRight(prepared_inputs[0]);
-						//printf("0x8002 Output: %d\n", outputs[tile_index]);
-					}
-					else if(strcmp("0x8003", function) == 0){
-						outputs[tile_index] = OctalAND(prepared_inputs[0], prepared_inputs[1]);
-						//printf("0x8003 Output: %d\n", outputs[tile_index]);
-					}
-					// Test for end of program
-					if(USER_PROGRAM[k + 1] == '#'){
-						//printf("FINAL OUTPUT1: %d", outputs[tile_index]);
-						//printf("\nEND OF PROGRAM\n");
-						f=0;
-						input_counter = 0;
-						k=0;
-						break;
-					}
-					else{
-						f=0;
-						input_counter = 0;
-						k++;
-					}
-				}
-				else{
-					k++;
-				}
+		EventDispatch();
+
+		//
+		// Compile a newly received program once, then keep it across resets
+		// and start it.
+		//
+		CompileProgram();
+		StartProgram();
+
+		//
+		// A supervisor fault holds the outputs safe until the host runs the
+		// program again.
+		//
+		if(program_compiled == 1 && !g_ui16SupervisorFaults){
+			if(g_bRunning){
+				ScanProgram();
+			}
+			else{
+				SupervisorService();
 			}
 		}
 		else{
-			EALLOW;
-			GpioDataRegs.GPBCLEAR.bit.GPIO44 = 1;
-			GpioDataRegs.GPACLEAR.bit.GPIO3 = 1;
-			GpioDataRegs.GPACLEAR.bit.GPIO16 = 1;
-			GpioDataRegs.GPACLEAR.bit.GPIO17 = 1;
-			GpioDataRegs.GPACLEAR.bit.GPIO13 = 1;
-			GpioDataRegs.GPBCLEAR.bit.GPIO50 = 1;
-			GpioDataRegs.GPBCLEAR.bit.GPIO51 = 1;
-			GpioDataRegs.GPBCLEAR.bit.GPIO55 = 1;
-
-			EDIS;
+			SupervisorSafeOutputs();
+			ExpansionSafeOutputs();
+			SupervisorService();
 		}
+
+		StreamValues();
+		LogicSend();
 	}
 }
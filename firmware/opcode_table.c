@@ -0,0 +1,250 @@
+//###########################################################################
+//
+// FILE:   opcode_table.c
+//
+// TITLE:  Tile opcode registration table.
+//
+// Automatically generated by software/gen_opcodes.py from the
+// libraries in software/lib/.  Do not edit!
+//
+//###########################################################################
+
+#include <stdint.h>
+
+#include "opcodes.h"
+
+extern int ReadInput(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int CapturedRising(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int CapturedFalling(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int AnalogInput(const int *piInputs, uint16_t ui16Count, int *piState);
+extern tValue InputFrequency(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue EncoderCount(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern int ExpansionInput(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int SetOutput(const int *piInputs, uint16_t ui16Count, int *piState);
+extern tValue PWMOutput(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern int ExpansionOutput(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalShiftLeft(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalShiftRight(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalAND(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int MultiAND(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int MultiOR(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int MultiXOR(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int MultiADD(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalOR(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalXOR(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OctalNOT(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int RisingEdge(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int FallingEdge(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int HexConstant(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OnDelay(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int OffDelay(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int Counter(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int Add(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int Subtract(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int GreaterThan(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int LessThan(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int Equal(const int *piInputs, uint16_t ui16Count, int *piState);
+extern tValue Constant32(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue Add32(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue Subtract32(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue Multiply32(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue ConstantIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue AddIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue SubtractIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue MultiplyIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue ConstantF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue AddF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue SubtractF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue MultiplyF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue DivideF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue GreaterThanF(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue IntToInt32(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue Int32ToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue IntToIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue IQToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue IntToFloat(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue FloatToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue IQToFloat(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue FloatToIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern tValue PID(const tValue *psInputs, uint16_t ui16Count, tValue *psState);
+extern int MovingAverage(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int FIRFilter(const int *piInputs, uint16_t ui16Count, int *piState);
+extern int Scale(const int *piInputs, uint16_t ui16Count, int *piState);
+
+const tOpcode g_psOpcodes[] =
+{
+    // ReadInput, inout.lib
+    { 0x2000, 0, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      ReadInput, 0 },
+    // CapturedRising, inout.lib
+    { 0x2001, 0, 0x0000, OPCODE_FLAG_BACKGROUND, 0, 0x00000000, OPCODE_TYPE_INT16,
+      CapturedRising, 0 },
+    // CapturedFalling, inout.lib
+    { 0x2002, 0, 0x0000, OPCODE_FLAG_BACKGROUND, 0, 0x00000000, OPCODE_TYPE_INT16,
+      CapturedFalling, 0 },
+    // AnalogInput, inout.lib
+    { 0x2003, 1, 0x0001, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      AnalogInput, 0 },
+    // InputFrequency, inout.lib
+    { 0x2004, 0, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_FLOAT,
+      0, InputFrequency },
+    // EncoderCount, inout.lib
+    { 0x2005, 2, 0x0001, 0, 0, 0x00000000, OPCODE_TYPE_INT32,
+      0, EncoderCount },
+    // ExpansionInput, inout.lib
+    { 0x2006, 1, 0x0001, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      ExpansionInput, 0 },
+    // SetOutput, inout.lib
+    { 0x4000, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      SetOutput, 0 },
+    // PWMOutput, inout.lib
+    { 0x4001, 3, 0x0001, 0, 0, 0x0000003C, OPCODE_TYPE_FLOAT,
+      0, PWMOutput },
+    // ExpansionOutput, inout.lib
+    { 0x4002, 2, 0x0001, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      ExpansionOutput, 0 },
+    // OctalShiftLeft, bitlib.lib
+    { 0x8001, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalShiftLeft, 0 },
+    // OctalShiftRight, bitlib.lib
+    { 0x8002, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalShiftRight, 0 },
+    // OctalAND, bitlib.lib
+    { 0x8003, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalAND, 0 },
+    // MultiAND, bitlib.lib
+    { 0x8004, 1, 0x0000, OPCODE_FLAG_VARIADIC, 0, 0x00000000, OPCODE_TYPE_INT16,
+      MultiAND, 0 },
+    // MultiOR, bitlib.lib
+    { 0x8005, 1, 0x0000, OPCODE_FLAG_VARIADIC, 0, 0x00000000, OPCODE_TYPE_INT16,
+      MultiOR, 0 },
+    // MultiXOR, bitlib.lib
+    { 0x8006, 1, 0x0000, OPCODE_FLAG_VARIADIC, 0, 0x00000000, OPCODE_TYPE_INT16,
+      MultiXOR, 0 },
+    // MultiADD, bitlib.lib
+    { 0x8007, 1, 0x0000, OPCODE_FLAG_VARIADIC, 0, 0x00000000, OPCODE_TYPE_INT16,
+      MultiADD, 0 },
+    // OctalOR, bitlib.lib
+    { 0x8008, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalOR, 0 },
+    // OctalXOR, bitlib.lib
+    { 0x8009, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalXOR, 0 },
+    // OctalNOT, bitlib.lib
+    { 0x800A, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      OctalNOT, 0 },
+    // RisingEdge, bitlib.lib
+    { 0x800B, 1, 0x0000, 0, 1, 0x00000000, OPCODE_TYPE_INT16,
+      RisingEdge, 0 },
+    // FallingEdge, bitlib.lib
+    { 0x800C, 1, 0x0000, 0, 1, 0x00000000, OPCODE_TYPE_INT16,
+      FallingEdge, 0 },
+    // HexConstant, const.lib
+    { 0xA001, 1, 0x0001, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      HexConstant, 0 },
+    // OnDelay, const.lib
+    { 0xA002, 2, 0x0002, 0, 1, 0x00000000, OPCODE_TYPE_INT16,
+      OnDelay, 0 },
+    // OffDelay, const.lib
+    { 0xA003, 2, 0x0002, 0, 1, 0x00000000, OPCODE_TYPE_INT16,
+      OffDelay, 0 },
+    // Counter, const.lib
+    { 0xA004, 2, 0x0000, 0, 2, 0x00000000, OPCODE_TYPE_INT16,
+      Counter, 0 },
+    // Add, math.lib
+    { 0xC001, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      Add, 0 },
+    // Subtract, math.lib
+    { 0xC002, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      Subtract, 0 },
+    // GreaterThan, math.lib
+    { 0xC003, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      GreaterThan, 0 },
+    // LessThan, math.lib
+    { 0xC004, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      LessThan, 0 },
+    // Equal, math.lib
+    { 0xC005, 2, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT16,
+      Equal, 0 },
+    // Constant32, typed.lib
+    { 0xC101, 1, 0x0001, 0, 0, 0x00000001, OPCODE_TYPE_INT32,
+      0, Constant32 },
+    // Add32, typed.lib
+    { 0xC102, 2, 0x0000, 0, 0, 0x00000005, OPCODE_TYPE_INT32,
+      0, Add32 },
+    // Subtract32, typed.lib
+    { 0xC103, 2, 0x0000, 0, 0, 0x00000005, OPCODE_TYPE_INT32,
+      0, Subtract32 },
+    // Multiply32, typed.lib
+    { 0xC104, 2, 0x0000, 0, 0, 0x00000005, OPCODE_TYPE_INT32,
+      0, Multiply32 },
+    // ConstantIQ, typed.lib
+    { 0xC201, 1, 0x0001, 0, 0, 0x00000002, OPCODE_TYPE_IQ,
+      0, ConstantIQ },
+    // AddIQ, typed.lib
+    { 0xC202, 2, 0x0000, 0, 0, 0x0000000A, OPCODE_TYPE_IQ,
+      0, AddIQ },
+    // SubtractIQ, typed.lib
+    { 0xC203, 2, 0x0000, 0, 0, 0x0000000A, OPCODE_TYPE_IQ,
+      0, SubtractIQ },
+    // MultiplyIQ, typed.lib
+    { 0xC204, 2, 0x0000, 0, 0, 0x0000000A, OPCODE_TYPE_IQ,
+      0, MultiplyIQ },
+    // ConstantF, typed.lib
+    { 0xC301, 1, 0x0001, 0, 0, 0x00000003, OPCODE_TYPE_FLOAT,
+      0, ConstantF },
+    // AddF, typed.lib
+    { 0xC302, 2, 0x0000, 0, 0, 0x0000000F, OPCODE_TYPE_FLOAT,
+      0, AddF },
+    // SubtractF, typed.lib
+    { 0xC303, 2, 0x0000, 0, 0, 0x0000000F, OPCODE_TYPE_FLOAT,
+      0, SubtractF },
+    // MultiplyF, typed.lib
+    { 0xC304, 2, 0x0000, 0, 0, 0x0000000F, OPCODE_TYPE_FLOAT,
+      0, MultiplyF },
+    // DivideF, typed.lib
+    { 0xC305, 2, 0x0000, 0, 0, 0x0000000F, OPCODE_TYPE_FLOAT,
+      0, DivideF },
+    // GreaterThanF, typed.lib
+    { 0xC306, 2, 0x0000, 0, 0, 0x0000000F, OPCODE_TYPE_INT16,
+      0, GreaterThanF },
+    // IntToInt32, typed.lib
+    { 0xC401, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_INT32,
+      0, IntToInt32 },
+    // Int32ToInt, typed.lib
+    { 0xC402, 1, 0x0000, 0, 0, 0x00000001, OPCODE_TYPE_INT16,
+      0, Int32ToInt },
+    // IntToIQ, typed.lib
+    { 0xC403, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_IQ,
+      0, IntToIQ },
+    // IQToInt, typed.lib
+    { 0xC404, 1, 0x0000, 0, 0, 0x00000002, OPCODE_TYPE_INT16,
+      0, IQToInt },
+    // IntToFloat, typed.lib
+    { 0xC405, 1, 0x0000, 0, 0, 0x00000000, OPCODE_TYPE_FLOAT,
+      0, IntToFloat },
+    // FloatToInt, typed.lib
+    { 0xC406, 1, 0x0000, 0, 0, 0x00000003, OPCODE_TYPE_INT16,
+      0, FloatToInt },
+    // IQToFloat, typed.lib
+    { 0xC407, 1, 0x0000, 0, 0, 0x00000002, OPCODE_TYPE_FLOAT,
+      0, IQToFloat },
+    // FloatToIQ, typed.lib
+    { 0xC408, 1, 0x0000, 0, 0, 0x00000003, OPCODE_TYPE_IQ,
+      0, FloatToIQ },
+    // PID, control.lib
+    { 0xC501, 8, 0x00FC, 0, 5, 0x00003FFF, OPCODE_TYPE_FLOAT,
+      0, PID },
+    // MovingAverage, filter.lib
+    { 0xE001, 2, 0x0002, OPCODE_FLAG_CLA, 1, 0x00000000, OPCODE_TYPE_INT16,
+      MovingAverage, 0 },
+    // FIRFilter, filter.lib
+    { 0xE002, 5, 0x001E, OPCODE_FLAG_CLA, 1, 0x00000000, OPCODE_TYPE_INT16,
+      FIRFilter, 0 },
+    // Scale, filter.lib
+    { 0xE003, 4, 0x000E, OPCODE_FLAG_CLA, 1, 0x00000000, OPCODE_TYPE_INT16,
+      Scale, 0 },
+};
+
+const uint16_t g_ui16NumOpcodes = sizeof(g_psOpcodes) /
+                                  sizeof(g_psOpcodes[0]);
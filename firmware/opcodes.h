@@ -0,0 +1,142 @@
+//###########################################################################
+//
+// FILE:   opcodes.h
+//
+// TITLE:  Tile opcode registration table.
+//
+//###########################################################################
+
+#ifndef __OPCODES_H__
+#define __OPCODES_H__
+
+//*****************************************************************************
+//
+// Value types.  Every value table slot holds 32 bits: int16 values sign
+// extended, int32 values, IQ values as Q16 fixed point (OPCODE_IQ_Q) and
+// float32 values for the FPU.
+//
+//*****************************************************************************
+#define OPCODE_TYPE_INT16           0
+#define OPCODE_TYPE_INT32           1
+#define OPCODE_TYPE_IQ              2
+#define OPCODE_TYPE_FLOAT           3
+#define OPCODE_TYPE_BITS            2
+#define OPCODE_TYPE_MASK            0x3
+
+#define OPCODE_IQ_Q                 16
+
+typedef union
+{
+    int32_t i32;
+    float f32;
+}
+tValue;
+
+//*****************************************************************************
+//
+// Tiles that only use int16 values have an int handler.  The inputs are
+// passed as one contiguous array in the order they are declared in the .lib
+// file, and the return value is stored as the tile's output.  Tiles that
+// declare state in their .lib entry get that many value table slots of their
+// own, kept from one scan to the next and cleared when a program is loaded;
+// an int handler sees them as an array of twice as many ints.
+//
+// Tiles with any other value type have a value handler instead, which works
+// on the slots directly.
+//
+//*****************************************************************************
+typedef int (*tTileHandler)(const int *piInputs, uint16_t ui16Count,
+                            int *piState);
+typedef tValue (*tValueHandler)(const tValue *psInputs, uint16_t ui16Count,
+                                tValue *psState);
+
+//*****************************************************************************
+//
+// The last input is declared "int..." and may be connected any number of
+// times.  ui16Inputs is then the minimum number of inputs.
+//
+//*****************************************************************************
+#define OPCODE_FLAG_VARIADIC        0x0001
+
+//*****************************************************************************
+//
+// The tile runs on the CLA; see cla.c.  Its handler only stages the inputs
+// and its first state slot holds the CLA job number, which the engine
+// assigns.  Library functions with codes from OPCODE_CLA_BASE up are CLA
+// tiles.
+//
+//*****************************************************************************
+#define OPCODE_FLAG_CLA             0x0002
+#define OPCODE_CLA_BASE             0xE000
+
+//*****************************************************************************
+//
+// The tile reads state that the background scan rebuilds between runs, such
+// as the captured edges, so a timed task would see it torn or out of date.
+// These tiles may only be in the background task.
+//
+//*****************************************************************************
+#define OPCODE_FLAG_BACKGROUND      0x0004
+
+//*****************************************************************************
+//
+// One entry per library function, keyed by its FunctionReference code.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The FunctionReference code from the .lib file.
+    //
+    uint16_t ui16Code;
+
+    //
+    // The number of inputs the tile takes.
+    //
+    uint16_t ui16Inputs;
+
+    //
+    // Bit n is set if input n is a "set" value fixed at compile time rather
+    // than an "int" connected to another tile.
+    //
+    uint16_t ui16SetMask;
+
+    //
+    // OPCODE_FLAG_* values.
+    //
+    uint16_t ui16Flags;
+
+    //
+    // The number of state slots each instance of the tile needs.
+    //
+    uint16_t ui16States;
+
+    //
+    // The OPCODE_TYPE_* of each input, OPCODE_TYPE_BITS per input from bit
+    // 0, and of the output.  The extra inputs of a variadic tile have the
+    // type of its last declared input.
+    //
+    uint32_t ui32InputTypes;
+    uint16_t ui16OutputType;
+
+    //
+    // One of the two is set.
+    //
+    tTileHandler pfnHandler;
+    tValueHandler pfnValueHandler;
+}
+tOpcode;
+
+//*****************************************************************************
+//
+// The table itself is generated from software/lib/*.lib by
+// software/gen_opcodes.py and is sorted by code.
+//
+//*****************************************************************************
+extern const tOpcode g_psOpcodes[];
+extern const uint16_t g_ui16NumOpcodes;
+
+extern const tOpcode *OpcodeFind(uint16_t ui16Code);
+extern uint16_t OpcodeInputType(const tOpcode *psOpcode, uint16_t ui16Input);
+
+#endif // __OPCODES_H__
@@ -0,0 +1,359 @@
+//###########################################################################
+//
+// FILE:   pattern.c
+//
+// TITLE:  Timed playback of output patterns.
+//
+// The host loads a buffer of output words and ePWM6 interrupts once per step
+// to write the next one to the pins, so the steps are spaced by the time
+// base rather than by the scan.  ePWM6 has no pin of its own here; it is
+// only used as a timer, since CPU timer 2 belongs to the logic analyser.
+//
+// The set and clear masks of every possible word are worked out once at
+// start up.  Each interrupt first writes the masks prepared by the one
+// before, so the pins change a fixed time after the counter zero, and only
+// then looks up the next step.  A step can still be late by as long as the
+// longest other interrupt; only the engine's timer 0 interrupt lets others
+// in while it runs its timed tasks, and then only after it has released
+// them.
+//
+// There are two buffers.  One plays while the host loads the other and
+// queues it; the interrupt moves on to the queued buffer without a gap and
+// tells the host the finished one is free, so a pattern of any length can
+// be streamed.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "events.h"
+#include "supervisor.h"
+#include "pattern.h"
+
+//*****************************************************************************
+//
+// The largest TBCTL.CLKDIV, which divides the clock by 2 ^ CLKDIV, and the
+// largest period in time base counts.
+//
+//*****************************************************************************
+#define PATTERN_MAX_CLKDIV          7
+#define PATTERN_MAX_COUNTS          65536UL
+
+//*****************************************************************************
+//
+// The port A and B pins set by an output word.  The pins cleared are the
+// rest of the pattern's pins.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32SetA;
+    uint32_t ui32SetB;
+}
+tPatternMasks;
+
+#pragma DATA_SECTION(g_psPatternMasks, "DMARAML8");
+static tPatternMasks g_psPatternMasks[256];
+
+//*****************************************************************************
+//
+// The two step buffers, one word per step.  The host loads the buffer that
+// is not playing.
+//
+//*****************************************************************************
+#pragma DATA_SECTION(g_ppui16PatternBanks, "DMARAML8");
+static uint16_t g_ppui16PatternBanks[2][PATTERN_BANK_SIZE];
+static volatile uint16_t g_pui16PatternLength[2];
+
+//*****************************************************************************
+//
+// Playback state.  g_ui16PatternBank is the buffer playing, or last played;
+// the other one is loaded and queued by the main loop and handed over to
+// the interrupt by g_bPatternQueued.
+//
+//*****************************************************************************
+static volatile uint16_t g_ui16PatternBank = 0;
+static volatile tBoolean g_bPatternQueued = false;
+static volatile tBoolean g_bPatternPlaying = false;
+static uint16_t g_ui16PatternIndex = 0;
+static uint16_t g_ui16PatternFlags = 0;
+
+volatile uint32_t g_ui32PatternPinsA = 0;
+volatile uint32_t g_ui32PatternPinsB = 0;
+
+//*****************************************************************************
+//
+// The masks the next interrupt writes.
+//
+//*****************************************************************************
+static uint32_t g_ui32NextSetA = 0;
+static uint32_t g_ui32NextClearA = 0;
+static uint32_t g_ui32NextSetB = 0;
+static uint32_t g_ui32NextClearB = 0;
+
+//*****************************************************************************
+//
+// Work out the masks of the step at g_ui16PatternIndex.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(PatternPrepare, "ramfuncs");
+static void
+PatternPrepare(void)
+{
+    const tPatternMasks *psMasks;
+
+    psMasks = &g_psPatternMasks[
+        g_ppui16PatternBanks[g_ui16PatternBank][g_ui16PatternIndex] & 0xFF];
+
+    g_ui32NextSetA = psMasks->ui32SetA & g_ui32PatternPinsA;
+    g_ui32NextClearA = g_ui32PatternPinsA ^ g_ui32NextSetA;
+    g_ui32NextSetB = psMasks->ui32SetB & g_ui32PatternPinsB;
+    g_ui32NextClearB = g_ui32PatternPinsB ^ g_ui32NextSetB;
+}
+
+//*****************************************************************************
+//
+// Stop the time base, leaving the pins as they are.  An interrupt already
+// pending writes nothing.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(PatternHalt, "ramfuncs");
+static void
+PatternHalt(void)
+{
+    EPwm6Regs.TBCTL.bit.CTRMODE = TB_FREEZE;
+    EPwm6Regs.ETSEL.bit.INTEN = 0;
+    EPwm6Regs.ETCLR.bit.INT = 1;
+
+    g_ui32NextSetA = g_ui32NextClearA = 0;
+    g_ui32NextSetB = g_ui32NextClearB = 0;
+    g_bPatternPlaying = false;
+}
+
+//*****************************************************************************
+//
+// ePWM6 counter zero interrupt: play one step.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(PatternStepISR, "ramfuncs");
+__interrupt void
+PatternStepISR(void)
+{
+    GpioDataRegs.GPACLEAR.all = g_ui32NextClearA;
+    GpioDataRegs.GPASET.all = g_ui32NextSetA;
+    GpioDataRegs.GPBCLEAR.all = g_ui32NextClearB;
+    GpioDataRegs.GPBSET.all = g_ui32NextSetB;
+
+    if(g_bPatternPlaying)
+    {
+        if(++g_ui16PatternIndex >= g_pui16PatternLength[g_ui16PatternBank])
+        {
+            g_ui16PatternIndex = 0;
+            if(g_bPatternQueued)
+            {
+                g_ui16PatternBank ^= 1;
+                g_bPatternQueued = false;
+                EventPost(EVENT_PATTERN);
+            }
+            else if(!(g_ui16PatternFlags & PATTERN_FLAG_LOOP))
+            {
+                PatternHalt();
+                EventPost(EVENT_PATTERN);
+            }
+        }
+
+        if(g_bPatternPlaying)
+        {
+            PatternPrepare();
+        }
+    }
+
+    EPwm6Regs.ETCLR.bit.INT = 1;
+    PieCtrlRegs.PIEACK.all = PIEACK_GROUP3;
+}
+
+//*****************************************************************************
+//
+// Clock ePWM6, hook up its interrupt with the time base stopped and work out
+// the masks of every output word.
+//
+//*****************************************************************************
+void
+PatternInit(void)
+{
+    uint16_t ui16Word;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR1.bit.EPWM6ENCLK = 1;
+    EDIS;
+
+    EPwm6Regs.TBCTL.bit.CTRMODE = TB_FREEZE;
+    EPwm6Regs.TBCTL.bit.PHSEN = TB_DISABLE;
+    EPwm6Regs.TBCTL.bit.SYNCOSEL = TB_SYNC_DISABLE;
+    EPwm6Regs.TBCTL.bit.HSPCLKDIV = TB_DIV1;
+    EPwm6Regs.TBCTL.bit.PRDLD = TB_IMMEDIATE;
+    EPwm6Regs.ETSEL.bit.INTEN = 0;
+    EPwm6Regs.ETSEL.bit.INTSEL = ET_CTR_ZERO;
+    EPwm6Regs.ETPS.bit.INTPRD = ET_1ST;
+    EPwm6Regs.ETCLR.bit.INT = 1;
+
+    for(ui16Word = 0; ui16Word < 256; ui16Word++)
+    {
+        SupervisorOutputMasks(ui16Word, &g_psPatternMasks[ui16Word].ui32SetA,
+                              &g_psPatternMasks[ui16Word].ui32SetB);
+    }
+
+    IntRegister(INT_EPWM6, PatternStepISR);
+    IntEnable(INT_EPWM6);
+}
+
+//*****************************************************************************
+//
+// Copy ui16Count output words, one per byte, into the buffer that is not
+// playing, starting at step ui16Offset.
+//
+// \return Returns \b false if that buffer is already queued or the words do
+// not fit.
+//
+//*****************************************************************************
+tBoolean
+PatternLoad(uint16_t ui16Offset, const unsigned char *pucWords,
+            uint16_t ui16Count)
+{
+    uint16_t *pui16Bank;
+    uint16_t ui16Index;
+
+    if(g_bPatternQueued || (ui16Offset > PATTERN_BANK_SIZE) ||
+       (ui16Count > PATTERN_BANK_SIZE - ui16Offset))
+    {
+        return(false);
+    }
+
+    pui16Bank = g_ppui16PatternBanks[g_ui16PatternBank ^ 1];
+    for(ui16Index = 0; ui16Index < ui16Count; ui16Index++)
+    {
+        pui16Bank[ui16Offset + ui16Index] = pucWords[ui16Index] & 0xFF;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Queue the first ui16Length steps of the loaded buffer to play after the
+// one playing, or first when playback starts.
+//
+// \return Returns \b false if a buffer is already queued or the length is
+// out of range.
+//
+//*****************************************************************************
+tBoolean
+PatternQueue(uint16_t ui16Length)
+{
+    if(g_bPatternQueued || (ui16Length == 0) ||
+       (ui16Length > PATTERN_BANK_SIZE))
+    {
+        return(false);
+    }
+
+    g_pui16PatternLength[g_ui16PatternBank ^ 1] = ui16Length;
+    g_bPatternQueued = true;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Start playing the queued buffer at ui32Rate steps a second on the outputs
+// set in ui16Outputs, stopping anything already playing.  The other outputs
+// are left to the program and the safe state.
+//
+// \return Returns \b false if the rate is out of range or nothing is
+// queued.
+//
+//*****************************************************************************
+tBoolean
+PatternStart(uint32_t ui32Rate, uint16_t ui16Outputs, uint16_t ui16Flags)
+{
+    uint32_t ui32Clock, ui32Divided, ui32PinsA, ui32PinsB;
+    uint16_t ui16ClkDiv;
+
+    if((ui32Rate < PATTERN_MIN_HZ) || (ui32Rate > PATTERN_MAX_HZ) ||
+       !g_bPatternQueued)
+    {
+        return(false);
+    }
+
+    PatternStop();
+
+    //
+    // Use the smallest divider the period fits with, for the finest timing.
+    //
+    ui32Clock = SysCtlClockGet(SYSTEM_CLOCK_SPEED);
+    for(ui16ClkDiv = 0; ui16ClkDiv < PATTERN_MAX_CLKDIV; ui16ClkDiv++)
+    {
+        if((ui32Clock >> ui16ClkDiv) / ui32Rate < PATTERN_MAX_COUNTS)
+        {
+            break;
+        }
+    }
+    ui32Divided = ui32Rate << ui16ClkDiv;
+
+    SupervisorOutputMasks(ui16Outputs, &ui32PinsA, &ui32PinsB);
+
+    g_ui16PatternBank ^= 1;
+    g_bPatternQueued = false;
+    g_ui16PatternIndex = 0;
+    g_ui16PatternFlags = ui16Flags;
+    g_ui32PatternPinsA = ui32PinsA;
+    g_ui32PatternPinsB = ui32PinsB;
+    PatternPrepare();
+    g_bPatternPlaying = true;
+
+    EPwm6Regs.TBCTL.bit.CLKDIV = ui16ClkDiv;
+    EPwm6Regs.TBPRD = ((ui32Clock + (ui32Divided / 2)) / ui32Divided) - 1;
+    EPwm6Regs.TBCTR = 0;
+    EPwm6Regs.ETCLR.bit.INT = 1;
+    EPwm6Regs.ETSEL.bit.INTEN = 1;
+    EPwm6Regs.TBCTL.bit.CTRMODE = TB_COUNT_UP;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Stop playing and give the pins back.  A queued buffer stays queued.  This
+// is also called from the engine timer interrupt on a scan overrun.
+//
+//*****************************************************************************
+void
+PatternStop(void)
+{
+    uint16_t ui16Status;
+
+    ui16Status = __disable_interrupts();
+    PatternHalt();
+    g_ui32PatternPinsA = 0;
+    g_ui32PatternPinsB = 0;
+    __restore_interrupts(ui16Status);
+}
+
+//*****************************************************************************
+//
+// Return the PATTERN_STATE flags.
+//
+//*****************************************************************************
+uint16_t
+PatternState(void)
+{
+    return((g_bPatternPlaying ? PATTERN_STATE_PLAYING : 0) |
+           (g_bPatternQueued ? PATTERN_STATE_QUEUED : 0));
+}
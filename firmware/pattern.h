@@ -0,0 +1,69 @@
+//###########################################################################
+//
+// FILE:   pattern.h
+//
+// TITLE:  Timed playback of output patterns.
+//
+//###########################################################################
+
+#ifndef __PATTERN_H__
+#define __PATTERN_H__
+
+//*****************************************************************************
+//
+// The step rates in Hz.  Below PATTERN_MIN_HZ the period no longer fits in
+// TBPRD at the largest clock divider.
+//
+//*****************************************************************************
+#define PATTERN_MIN_HZ              10
+#define PATTERN_MAX_HZ              100000
+
+//*****************************************************************************
+//
+// The steps held by each of the two pattern buffers.  A step is one output
+// word, bit n driving output n as for SetOutput().
+//
+//*****************************************************************************
+#define PATTERN_BANK_SIZE           1024
+
+//*****************************************************************************
+//
+// Flags for PatternStart().
+//
+// PATTERN_FLAG_LOOP    replay the playing buffer when it ends with nothing
+//                      queued, rather than stopping on its last step.
+//
+//*****************************************************************************
+#define PATTERN_FLAG_LOOP           0x01
+
+//*****************************************************************************
+//
+// PatternState() flags.
+//
+// PATTERN_STATE_PLAYING    the steps are being played.
+// PATTERN_STATE_QUEUED     a buffer is queued to follow the one playing, so
+//                          no more can be loaded yet.
+//
+//*****************************************************************************
+#define PATTERN_STATE_PLAYING       0x01
+#define PATTERN_STATE_QUEUED        0x02
+
+//*****************************************************************************
+//
+// The GPIO pins held by the pattern, as masks of the A and B ports, or 0
+// when it is stopped.  The safe outputs leave these pins alone.
+//
+//*****************************************************************************
+extern volatile uint32_t g_ui32PatternPinsA;
+extern volatile uint32_t g_ui32PatternPinsB;
+
+extern void PatternInit(void);
+extern tBoolean PatternLoad(uint16_t ui16Offset, const unsigned char *pucWords,
+                            uint16_t ui16Count);
+extern tBoolean PatternQueue(uint16_t ui16Length);
+extern tBoolean PatternStart(uint32_t ui32Rate, uint16_t ui16Outputs,
+                             uint16_t ui16Flags);
+extern void PatternStop(void);
+extern uint16_t PatternState(void);
+
+#endif // __PATTERN_H__
@@ -0,0 +1,210 @@
+//###########################################################################
+//
+// FILE:   program_store.c
+//
+// TITLE:  Flash-resident user program storage.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "Flash2806x_API_Library.h"
+#include "program_store.h"
+#include "supervisor.h"
+
+//*****************************************************************************
+//
+// The stored image.  The program characters follow the header directly.
+//
+//*****************************************************************************
+#define STORE_HEADER    ((const tProgramHeader *)PROGRAM_STORE_BASE)
+#define STORE_PROGRAM   ((const char *)(PROGRAM_STORE_BASE +                  \
+                                        sizeof(tProgramHeader)))
+#define STORE_CAPACITY  (PROGRAM_STORE_SIZE - sizeof(tProgramHeader))
+
+//*****************************************************************************
+//
+// Calculate the CRC-16 (CCITT, 0x1021) of a program.  Only the low byte of
+// each character is used since that is all that was received over USB.
+//
+//*****************************************************************************
+static uint16_t
+ProgramCRC(const char *pcProgram, uint32_t ui32Length)
+{
+    uint16_t ui16CRC;
+    uint16_t ui16Bit;
+
+    ui16CRC = 0xFFFF;
+
+    while(ui32Length--)
+    {
+        ui16CRC ^= (uint16_t)(*pcProgram++ & 0xFF) << 8;
+
+        for(ui16Bit = 0; ui16Bit < 8; ui16Bit++)
+        {
+            if(ui16CRC & 0x8000)
+            {
+                ui16CRC = (ui16CRC << 1) ^ 0x1021;
+            }
+            else
+            {
+                ui16CRC <<= 1;
+            }
+        }
+    }
+
+    return(ui16CRC);
+}
+
+//*****************************************************************************
+//
+// Check that the stored header describes a program this firmware can run.
+//
+// \return Returns the stored program length, or 0 if there is no valid image.
+//
+//*****************************************************************************
+static uint32_t
+ProgramStoreCheck(void)
+{
+    const tProgramHeader *psHeader = STORE_HEADER;
+
+    if((psHeader->ui16Magic != PROGRAM_STORE_MAGIC) ||
+       (psHeader->ui16Version != PROGRAM_STORE_VERSION) ||
+       (psHeader->ui32Length == 0) ||
+       (psHeader->ui32Length > STORE_CAPACITY))
+    {
+        return(0);
+    }
+
+    if(ProgramCRC(STORE_PROGRAM, psHeader->ui32Length) != psHeader->ui16CRC)
+    {
+        return(0);
+    }
+
+    return(psHeader->ui32Length);
+}
+
+//*****************************************************************************
+//
+// Copy the program stored in flash into RAM.
+//
+// \param pcProgram is the buffer that receives the program.
+// \param ui32MaxLength is the size of that buffer.
+//
+// This is called once at boot, before the USB stack is started, so that a
+// board that has been programmed once starts running without a host.
+//
+// \return Returns the number of characters copied, or 0 if flash does not
+// hold a valid program that fits in the buffer.
+//
+//*****************************************************************************
+uint32_t
+ProgramStoreLoad(char *pcProgram, uint32_t ui32MaxLength)
+{
+    uint32_t ui32Length;
+
+    ui32Length = ProgramStoreCheck();
+    if((ui32Length == 0) || (ui32Length > ui32MaxLength))
+    {
+        return(0);
+    }
+
+    memcpy(pcProgram, STORE_PROGRAM, ui32Length);
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+// The amount of the PROGRAM_STORE_SIZE word sector taken by the stored
+// image, header included.
+//
+// \return Returns the number of words used, or 0 if no valid image is stored.
+//
+//*****************************************************************************
+uint32_t
+ProgramStoreUsed(void)
+{
+    uint32_t ui32Length;
+
+    ui32Length = ProgramStoreCheck();
+
+    return(ui32Length ? (ui32Length + sizeof(tProgramHeader)) : 0);
+}
+
+//*****************************************************************************
+//
+// Write a program to flash so it survives a reset.
+//
+// \param pcProgram is the received program.
+// \param ui32Length is its length in characters.
+//
+// The sector is only erased if the program differs from the one already
+// stored, so re-uploading the same program does not wear the flash.  The
+// flash API runs from boot ROM and this function is placed in ramfuncs, but
+// every ISR still lives in flash, so interrupts are held off for the whole
+// erase/program cycle and the flash API services the watchdog meanwhile.
+//
+// \return Returns \b true if the program is stored in flash on return.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(ProgramStoreSave, "ramfuncs");
+tBoolean
+ProgramStoreSave(const char *pcProgram, uint32_t ui32Length)
+{
+    tProgramHeader sHeader;
+    FLASH_ST sStatus;
+    uint16_t ui16Result, ui16Status;
+
+    if((ui32Length == 0) || (ui32Length > STORE_CAPACITY))
+    {
+        return(false);
+    }
+
+    memset(&sHeader, 0xFF, sizeof(sHeader));
+    sHeader.ui16Magic = PROGRAM_STORE_MAGIC;
+    sHeader.ui16Version = PROGRAM_STORE_VERSION;
+    sHeader.ui32Length = ui32Length;
+    sHeader.ui16CRC = ProgramCRC(pcProgram, ui32Length);
+
+    //
+    // Nothing to do if this exact program is already stored.
+    //
+    if((ProgramStoreCheck() == ui32Length) &&
+       (STORE_HEADER->ui16CRC == sHeader.ui16CRC))
+    {
+        return(true);
+    }
+
+    ui16Status = __disable_interrupts();
+
+    EALLOW;
+    Flash_CPUScaleFactor = (uint32_t)(1048576.0L *
+                                      (200L / PROGRAM_STORE_CPU_RATE));
+    Flash_CallbackPtr = &SupervisorService;
+    EDIS;
+
+    ui16Result = Flash_Erase(PROGRAM_STORE_SECTOR, &sStatus);
+
+    if(ui16Result == STATUS_SUCCESS)
+    {
+        ui16Result = Flash_Program((Uint16 *)STORE_PROGRAM,
+                                   (Uint16 *)pcProgram, ui32Length, &sStatus);
+    }
+
+    if(ui16Result == STATUS_SUCCESS)
+    {
+        ui16Result = Flash_Program((Uint16 *)STORE_HEADER, (Uint16 *)&sHeader,
+                                   sizeof(sHeader), &sStatus);
+    }
+
+    __restore_interrupts(ui16Status);
+
+    return((ui16Result == STATUS_SUCCESS) &&
+           (ProgramStoreCheck() == ui32Length));
+}
@@ -0,0 +1,54 @@
+//###########################################################################
+//
+// FILE:   program_store.h
+//
+// TITLE:  Flash-resident user program storage.
+//
+//###########################################################################
+
+#ifndef __PROGRAM_STORE_H__
+#define __PROGRAM_STORE_H__
+
+//*****************************************************************************
+//
+// The user program is kept in flash sector H, which the F28069 linker command
+// file leaves unused.  The header is written last so that an interrupted
+// write never leaves a header describing a program that is not there.
+//
+//*****************************************************************************
+#define PROGRAM_STORE_SECTOR        SECTORH
+#define PROGRAM_STORE_BASE          0x3D8000
+#define PROGRAM_STORE_SIZE          0x4000
+
+//*****************************************************************************
+//
+// Header identification.  Bump PROGRAM_STORE_VERSION whenever the stored
+// program encoding changes so that an old image is not run by new firmware.
+//
+//*****************************************************************************
+#define PROGRAM_STORE_MAGIC         0x5043
+#define PROGRAM_STORE_VERSION       1
+
+//*****************************************************************************
+//
+// SYSCLKOUT period in nanoseconds, used to scale the flash API timing.  This
+// must match the PLL setup in SysCtrlInit() (80MHz).
+//
+//*****************************************************************************
+#define PROGRAM_STORE_CPU_RATE      12.500L
+
+typedef struct
+{
+    uint16_t ui16Magic;
+    uint16_t ui16Version;
+    uint32_t ui32Length;
+    uint16_t ui16CRC;
+    uint16_t ui16Reserved[3];
+}
+tProgramHeader;
+
+extern uint32_t ProgramStoreLoad(char *pcProgram, uint32_t ui32MaxLength);
+extern tBoolean ProgramStoreSave(const char *pcProgram, uint32_t ui32Length);
+extern uint32_t ProgramStoreUsed(void);
+
+#endif // __PROGRAM_STORE_H__
@@ -0,0 +1,299 @@
+//###########################################################################
+//
+// FILE:   protocol.c
+//
+// TITLE:  Binary host command protocol.
+//
+// Framing for the command set carried over the CDC serial channel.  The
+// commands themselves are carried out in main.c.
+//
+//###########################################################################
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdcdc.h"
+#include "usb_serial_structs.h"
+#include "protocol.h"
+
+//*****************************************************************************
+//
+// Receive states.
+//
+//*****************************************************************************
+#define STATE_SYNC                  0
+#define STATE_ID                    1
+#define STATE_COMMAND               2
+#define STATE_LENGTH                3
+#define STATE_PAYLOAD               4
+#define STATE_CHECK                 5
+
+//*****************************************************************************
+//
+// Wait for the start of the next frame.
+//
+//*****************************************************************************
+void
+ProtocolReset(tFrameParser *psParser)
+{
+    psParser->ui16State = STATE_SYNC;
+    psParser->ui16Index = 0;
+    psParser->ui16Check = 0;
+}
+
+//*****************************************************************************
+//
+// Feed one received byte to the parser.
+//
+// \return Returns \b true when the byte completes a frame with a good check
+// byte; the frame is then in psParser->sFrame until the next call.  A frame
+// that is too long or fails its check is dropped and the parser goes back to
+// looking for the sync byte.
+//
+//*****************************************************************************
+tBoolean
+ProtocolParse(tFrameParser *psParser, unsigned char ucChar)
+{
+    tFrame *psFrame = &psParser->sFrame;
+
+    ucChar &= 0xFF;
+
+    switch(psParser->ui16State)
+    {
+    case STATE_SYNC:
+    {
+        if(ucChar == PROTOCOL_SYNC)
+        {
+            psParser->ui16Check = 0;
+            psParser->ui16State = STATE_ID;
+        }
+        break;
+    }
+
+    case STATE_ID:
+    {
+        psFrame->ui16ID = ucChar;
+        psParser->ui16Check += ucChar;
+        psParser->ui16State = STATE_COMMAND;
+        break;
+    }
+
+    case STATE_COMMAND:
+    {
+        psFrame->ui16Command = ucChar;
+        psParser->ui16Check += ucChar;
+        psParser->ui16State = STATE_LENGTH;
+        break;
+    }
+
+    case STATE_LENGTH:
+    {
+        if(ucChar > PROTOCOL_MAX_PAYLOAD)
+        {
+            ProtocolReset(psParser);
+            break;
+        }
+
+        psFrame->ui16Length = ucChar;
+        psParser->ui16Check += ucChar;
+        psParser->ui16Index = 0;
+        psParser->ui16State = ucChar ? STATE_PAYLOAD : STATE_CHECK;
+        break;
+    }
+
+    case STATE_PAYLOAD:
+    {
+        psFrame->pucPayload[psParser->ui16Index++] = ucChar;
+        psParser->ui16Check += ucChar;
+        if(psParser->ui16Index == psFrame->ui16Length)
+        {
+            psParser->ui16State = STATE_CHECK;
+        }
+        break;
+    }
+
+    case STATE_CHECK:
+    {
+        psParser->ui16State = STATE_SYNC;
+        return((psParser->ui16Check & 0xFF) == ucChar);
+    }
+
+    default:
+    {
+        ProtocolReset(psParser);
+        break;
+    }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Write one byte at the writer's position in the transmit ring.
+//
+//*****************************************************************************
+static void
+WriteByte(tFrameWriter *psWriter, uint16_t ui16Value)
+{
+    psWriter->sRing.pui8Buffer[psWriter->ui32Index] = ui16Value & 0xFF;
+
+    if(++psWriter->ui32Index == psWriter->sRing.ui32Size)
+    {
+        psWriter->ui32Index = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Start a frame directly in the transmit buffer.
+//
+// Room for a maximum sized frame is required so the payload can be written
+// without further checks.  The length byte is filled in by ProtocolEnd().
+//
+// \return Returns \b false, and starts nothing, if the buffer is too full.
+//
+//*****************************************************************************
+tBoolean
+ProtocolBegin(tFrameWriter *psWriter, uint16_t ui16ID, uint16_t ui16Command)
+{
+    if(USBBufferSpaceAvailable(&g_sTxBuffer) < PROTOCOL_MAX_FRAME)
+    {
+        return(false);
+    }
+
+    USBBufferInfoGet(&g_sTxBuffer, &psWriter->sRing);
+    psWriter->ui32Index = psWriter->sRing.ui32WriteIndex;
+
+    WriteByte(psWriter, PROTOCOL_SYNC);
+    WriteByte(psWriter, ui16ID);
+    WriteByte(psWriter, ui16Command);
+
+    //
+    // Skip the length byte for now.
+    //
+    psWriter->ui32Length = psWriter->ui32Index;
+    WriteByte(psWriter, 0);
+
+    psWriter->ui16Count = 0;
+    psWriter->ui16Check = (ui16ID & 0xFF) + (ui16Command & 0xFF);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Append payload fields to a frame started with ProtocolBegin().  Anything
+// past PROTOCOL_MAX_PAYLOAD bytes is dropped.
+//
+//*****************************************************************************
+void
+ProtocolWrite8(tFrameWriter *psWriter, uint16_t ui16Value)
+{
+    if(psWriter->ui16Count < PROTOCOL_MAX_PAYLOAD)
+    {
+        WriteByte(psWriter, ui16Value);
+        psWriter->ui16Check += ui16Value & 0xFF;
+        psWriter->ui16Count++;
+    }
+}
+
+void
+ProtocolWrite16(tFrameWriter *psWriter, uint16_t ui16Value)
+{
+    ProtocolWrite8(psWriter, ui16Value & 0xFF);
+    ProtocolWrite8(psWriter, ui16Value >> 8);
+}
+
+void
+ProtocolWrite32(tFrameWriter *psWriter, uint32_t ui32Value)
+{
+    ProtocolWrite16(psWriter, (uint16_t)ui32Value);
+    ProtocolWrite16(psWriter, (uint16_t)(ui32Value >> 16));
+}
+
+//*****************************************************************************
+//
+// Finish a frame and hand it to the USB buffer for transmission.
+//
+//*****************************************************************************
+void
+ProtocolEnd(tFrameWriter *psWriter)
+{
+    psWriter->sRing.pui8Buffer[psWriter->ui32Length] = psWriter->ui16Count;
+    psWriter->ui16Check += psWriter->ui16Count;
+
+    WriteByte(psWriter, psWriter->ui16Check);
+
+    USBBufferDataWritten(&g_sTxBuffer,
+                         psWriter->ui16Count + PROTOCOL_OVERHEAD);
+}
+
+//*****************************************************************************
+//
+// Send a frame to the host.
+//
+// The frame is only queued if it fits in the transmit buffer as a whole, so
+// frames are never interleaved or cut short.
+//
+// \return Returns \b true if the frame was queued.
+//
+//*****************************************************************************
+tBoolean
+ProtocolSend(uint16_t ui16ID, uint16_t ui16Command,
+             const unsigned char *pucPayload, uint16_t ui16Length)
+{
+    tFrameWriter sWriter;
+    uint16_t ui16Index;
+
+    if((ui16Length > PROTOCOL_MAX_PAYLOAD) ||
+       !ProtocolBegin(&sWriter, ui16ID, ui16Command))
+    {
+        return(false);
+    }
+
+    for(ui16Index = 0; ui16Index < ui16Length; ui16Index++)
+    {
+        ProtocolWrite8(&sWriter, pucPayload[ui16Index]);
+    }
+
+    ProtocolEnd(&sWriter);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Little endian field helpers.
+//
+//*****************************************************************************
+uint16_t
+ProtocolGet16(const unsigned char *pucData)
+{
+    return((pucData[0] & 0xFF) | ((uint16_t)(pucData[1] & 0xFF) << 8));
+}
+
+uint32_t
+ProtocolGet32(const unsigned char *pucData)
+{
+    return(ProtocolGet16(pucData) |
+           ((uint32_t)ProtocolGet16(pucData + 2) << 16));
+}
+
+void
+ProtocolPut16(unsigned char *pucData, uint16_t ui16Value)
+{
+    pucData[0] = ui16Value & 0xFF;
+    pucData[1] = ui16Value >> 8;
+}
+
+void
+ProtocolPut32(unsigned char *pucData, uint32_t ui32Value)
+{
+    ProtocolPut16(pucData, (uint16_t)ui32Value);
+    ProtocolPut16(pucData + 2, (uint16_t)(ui32Value >> 16));
+}
@@ -0,0 +1,136 @@
+//###########################################################################
+//
+// FILE:   protocol.h
+//
+// TITLE:  Binary host command protocol.
+//
+//###########################################################################
+
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+//*****************************************************************************
+//
+// Frame layout, in both directions:
+//
+//     sync (0xA5), ID, command, length, payload[length], check
+//
+// The check byte is the 8-bit sum of the ID, command, length and payload
+// bytes.  A response echoes the ID and command of its request with
+// PROTOCOL_RESPONSE set and carries a status byte as the first payload byte.
+// Unsolicited stream, fault, capture and pattern frames use ID 0.
+// Multi-byte fields are little endian.
+//
+// A frame fits in one 64 byte USB packet.
+//
+//*****************************************************************************
+#define PROTOCOL_SYNC               0xA5
+#define PROTOCOL_MAX_PAYLOAD        59
+#define PROTOCOL_OVERHEAD           5
+#define PROTOCOL_MAX_FRAME          (PROTOCOL_MAX_PAYLOAD + PROTOCOL_OVERHEAD)
+
+//*****************************************************************************
+//
+// Commands.
+//
+//*****************************************************************************
+#define CMD_PING                    0x00
+#define CMD_UPLOAD                  0x01    // offset16, program bytes
+#define CMD_RUN                     0x02
+#define CMD_STOP                    0x03
+#define CMD_STEP                    0x04
+#define CMD_READ_VALUE              0x05    // slot16 -> value32
+#define CMD_WRITE_VALUE             0x06    // slot16, value32
+#define CMD_STATS                   0x07    // -> tProtocolStats fields
+#define CMD_STREAM                  0x08    // period16, slot16... -> value32...
+#define CMD_MEMORY                  0x09    // -> stack, store and table use
+#define CMD_FAULT                   0x0A    // -> faults16, overruns16, safe8
+#define CMD_SAFE_STATE              0x0B    // safe8
+#define CMD_CAPTURE                 0x0C    // rate32 -> flags8, run16...
+#define CMD_PATTERN_LOAD            0x0D    // offset16, word8...
+#define CMD_PATTERN_QUEUE           0x0E    // length16 -> state8
+#define CMD_PATTERN_PLAY            0x0F    // rate32, outputs8, flags8 -> state8
+#define PROTOCOL_RESPONSE           0x80
+
+//*****************************************************************************
+//
+// Response status.
+//
+//*****************************************************************************
+#define STATUS_OK                   0x00
+#define STATUS_BAD_COMMAND          0x01
+#define STATUS_BAD_LENGTH           0x02
+#define STATUS_BAD_ARGUMENT         0x03
+#define STATUS_REJECTED             0x04
+
+//*****************************************************************************
+//
+// Whether the compiled program is saved to flash to run after a reset, as
+// given in the CMD_STATS response.
+//
+//*****************************************************************************
+#define STORE_PENDING               0x00
+#define STORE_SAVED                 0x01
+#define STORE_FAILED                0x02
+
+//*****************************************************************************
+//
+// A received frame, one byte per word.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16ID;
+    uint16_t ui16Command;
+    uint16_t ui16Length;
+    unsigned char pucPayload[PROTOCOL_MAX_PAYLOAD];
+}
+tFrame;
+
+//*****************************************************************************
+//
+// Receive state machine.  Clear it with ProtocolReset() before use.
+//
+//*****************************************************************************
+typedef struct
+{
+    tFrame sFrame;
+    uint16_t ui16State;
+    uint16_t ui16Index;
+    uint16_t ui16Check;
+}
+tFrameParser;
+
+//*****************************************************************************
+//
+// A frame being built in place in the transmit buffer.  Between
+// ProtocolBegin() and ProtocolEnd() nothing else may write to g_sTxBuffer.
+//
+//*****************************************************************************
+typedef struct
+{
+    tUSBRingBufObject sRing;
+    uint32_t ui32Length;
+    uint32_t ui32Index;
+    uint16_t ui16Count;
+    uint16_t ui16Check;
+}
+tFrameWriter;
+
+extern void ProtocolReset(tFrameParser *psParser);
+extern tBoolean ProtocolParse(tFrameParser *psParser, unsigned char ucChar);
+extern tBoolean ProtocolSend(uint16_t ui16ID, uint16_t ui16Command,
+                             const unsigned char *pucPayload,
+                             uint16_t ui16Length);
+extern tBoolean ProtocolBegin(tFrameWriter *psWriter, uint16_t ui16ID,
+                              uint16_t ui16Command);
+extern void ProtocolWrite8(tFrameWriter *psWriter, uint16_t ui16Value);
+extern void ProtocolWrite16(tFrameWriter *psWriter, uint16_t ui16Value);
+extern void ProtocolWrite32(tFrameWriter *psWriter, uint32_t ui32Value);
+extern void ProtocolEnd(tFrameWriter *psWriter);
+extern uint16_t ProtocolGet16(const unsigned char *pucData);
+extern uint32_t ProtocolGet32(const unsigned char *pucData);
+extern void ProtocolPut16(unsigned char *pucData, uint16_t ui16Value);
+extern void ProtocolPut32(unsigned char *pucData, uint32_t ui32Value);
+
+#endif // __PROTOCOL_H__
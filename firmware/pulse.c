@@ -0,0 +1,269 @@
+//###########################################################################
+//
+// FILE:   pulse.c
+//
+// TITLE:  Frequency measurement and pulse counting by eCAP1 and eQEP1.
+//
+// Both peripherals do their work on every edge in hardware, so pulse trains
+// far faster than the scan are measured without interrupts, and a tile reads
+// the result in a fixed few register accesses.
+//
+// eCAP1 times GPIO19 (ReadInput() bit 6, which still reads the pin).  It
+// runs in delta mode, capturing the time since the previous rising edge into
+// CAP1 and restarting its counter, so CAP1 always holds the last full period.
+//
+// eQEP1 counts on GPIO20 and GPIO21 into its 32-bit position counter.  It is
+// set up by the first tile to use it and stopped when a program is loaded.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+#include "F2806x_ECap_defines.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "pulse.h"
+
+//*****************************************************************************
+//
+// Pin mux settings, from the F2806x data manual.
+//
+//*****************************************************************************
+#define PULSE_GPIO19_MUX_ECAP1      3
+#define PULSE_GPIO20_MUX_EQEP1A     1
+#define PULSE_GPIO21_MUX_EQEP1B     1
+
+//*****************************************************************************
+//
+// eQEP settings, from the F2806x eQEP reference guide.
+//
+//*****************************************************************************
+#define QEP_QSRC_QUADRATURE         0
+#define QEP_QSRC_UP_COUNT           2
+#define QEP_PCRM_MAX_POSITION       1
+#define QEP_FREE_SOFT_FREE          2
+
+//*****************************************************************************
+//
+// The eQEP mode set up by the last PulseCount(), or PULSE_MODE_NONE while it
+// is stopped.
+//
+//*****************************************************************************
+#define PULSE_MODE_NONE             0xFFFF
+
+static uint16_t g_ui16QepMode = PULSE_MODE_NONE;
+
+//*****************************************************************************
+//
+// PULSE_TIMEOUT_S in eCAP counts.
+//
+//*****************************************************************************
+static uint32_t g_ui32CapTimeout;
+
+//*****************************************************************************
+//
+// True once GPIO19 has had no edge for PULSE_TIMEOUT_S, until the next one.
+//
+//*****************************************************************************
+static bool g_bCapStalled = false;
+
+//*****************************************************************************
+//
+// Start eCAP1 timing the rising edges of GPIO19.
+//
+//*****************************************************************************
+static void
+PulseCapInit(void)
+{
+    EALLOW;
+    SysCtrlRegs.PCLKCR1.bit.ECAP1ENCLK = 1;
+    GpioCtrlRegs.GPAPUD.bit.GPIO19 = 0;
+    GpioCtrlRegs.GPAQSEL2.bit.GPIO19 = 0;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO19 = PULSE_GPIO19_MUX_ECAP1;
+    EDIS;
+
+    ECap1Regs.ECEINT.all = 0;
+    ECap1Regs.ECCLR.all = 0xFFFF;
+    ECap1Regs.ECCTL1.bit.CAPLDEN = EC_DISABLE;
+    ECap1Regs.ECCTL2.bit.TSCTRSTOP = EC_FREEZE;
+
+    ECap1Regs.ECCTL1.bit.CAP1POL = EC_RISING;
+    ECap1Regs.ECCTL1.bit.CTRRST1 = EC_DELTA_MODE;
+    ECap1Regs.ECCTL1.bit.PRESCALE = EC_DIV1;
+    ECap1Regs.ECCTL1.bit.FREE_SOFT = 2;
+
+    ECap1Regs.ECCTL2.bit.CAP_APWM = EC_CAP_MODE;
+    ECap1Regs.ECCTL2.bit.CONT_ONESHT = EC_CONTINUOUS;
+    ECap1Regs.ECCTL2.bit.STOP_WRAP = EC_EVENT1;
+    ECap1Regs.ECCTL2.bit.SYNCI_EN = EC_DISABLE;
+    ECap1Regs.ECCTL2.bit.SYNCO_SEL = EC_SYNCO_DIS;
+
+    ECap1Regs.TSCTR = 0;
+    ECap1Regs.CAP1 = 0;
+    ECap1Regs.ECCTL1.bit.CAPLDEN = EC_ENABLE;
+    ECap1Regs.ECCTL2.bit.REARM = 1;
+    ECap1Regs.ECCTL2.bit.TSCTRSTOP = EC_RUN;
+}
+
+//*****************************************************************************
+//
+// Start the frequency measurement and clock eQEP1, which is set up on first
+// use.
+//
+//*****************************************************************************
+void
+PulseInit(void)
+{
+    g_ui32CapTimeout = SysCtlClockGet(SYSTEM_CLOCK_SPEED) * PULSE_TIMEOUT_S;
+
+    PulseCapInit();
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR1.bit.EQEP1ENCLK = 1;
+    EDIS;
+
+    PulseReset();
+}
+
+//*****************************************************************************
+//
+// Stop eQEP1 and give its pins back to the GPIO.  This is called when a
+// program is loaded, so each program counts from zero.
+//
+//*****************************************************************************
+void
+PulseReset(void)
+{
+    EQep1Regs.QEPCTL.bit.QPEN = 0;
+    EQep1Regs.QPOSCNT = 0;
+
+    EALLOW;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO20 = 0;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO21 = 0;
+    EDIS;
+
+    g_ui16QepMode = PULSE_MODE_NONE;
+}
+
+//*****************************************************************************
+//
+// Return the frequency of GPIO19 in Hz.
+//
+// Once the time since the last edge is longer than the last period, the
+// signal has slowed or stopped, and that time is the better estimate; so
+// the reading falls smoothly to 0 rather than holding the last frequency.
+//
+// The counter runs on while the signal is stopped, and after about 47 s at
+// 90 MHz it wraps and looks recent again; so the stall is latched here and
+// only cleared by the next capture event, seen in CEVT1.
+//
+//*****************************************************************************
+float
+PulseFrequency(void)
+{
+    uint32_t ui32Period, ui32Since;
+
+    if(ECap1Regs.ECFLG.bit.CEVT1)
+    {
+        ECap1Regs.ECCLR.bit.CEVT1 = 1;
+        g_bCapStalled = false;
+    }
+
+    ui32Period = ECap1Regs.CAP1;
+    ui32Since = ECap1Regs.TSCTR;
+
+    if(g_bCapStalled || (ui32Since >= g_ui32CapTimeout))
+    {
+        g_bCapStalled = true;
+        return(0.0f);
+    }
+    if(ui32Since > ui32Period)
+    {
+        ui32Period = ui32Since;
+    }
+    if(ui32Period == 0)
+    {
+        return(0.0f);
+    }
+
+    return((float)SysCtlClockGet(SYSTEM_CLOCK_SPEED) / (float)ui32Period);
+}
+
+//*****************************************************************************
+//
+// Set eQEP1 counting in the given mode, from zero, with its position
+// counter wrapping at 32 bits.
+//
+//*****************************************************************************
+static void
+PulseQepStart(uint16_t ui16Mode)
+{
+    EQep1Regs.QEPCTL.bit.QPEN = 0;
+
+    EALLOW;
+    GpioCtrlRegs.GPAPUD.bit.GPIO20 = 0;
+    GpioCtrlRegs.GPAPUD.bit.GPIO21 = 0;
+    GpioCtrlRegs.GPAQSEL2.bit.GPIO20 = 0;
+    GpioCtrlRegs.GPAQSEL2.bit.GPIO21 = 0;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO20 = PULSE_GPIO20_MUX_EQEP1A;
+    GpioCtrlRegs.GPAMUX2.bit.GPIO21 =
+        (ui16Mode == PULSE_MODE_QUADRATURE) ? PULSE_GPIO21_MUX_EQEP1B : 0;
+    EDIS;
+
+    EQep1Regs.QDECCTL.all = 0;
+    if(ui16Mode == PULSE_MODE_QUADRATURE)
+    {
+        EQep1Regs.QDECCTL.bit.QSRC = QEP_QSRC_QUADRATURE;
+    }
+    else
+    {
+        //
+        // Count rising edges only.
+        //
+        EQep1Regs.QDECCTL.bit.QSRC = QEP_QSRC_UP_COUNT;
+        EQep1Regs.QDECCTL.bit.XCR = 1;
+    }
+
+    EQep1Regs.QPOSINIT = 0;
+    EQep1Regs.QPOSMAX = 0xFFFFFFFF;
+    EQep1Regs.QEPCTL.all = 0;
+    EQep1Regs.QEPCTL.bit.FREE_SOFT = QEP_FREE_SOFT_FREE;
+    EQep1Regs.QEPCTL.bit.PCRM = QEP_PCRM_MAX_POSITION;
+    EQep1Regs.QPOSCNT = 0;
+    EQep1Regs.QEPCTL.bit.QPEN = 1;
+
+    g_ui16QepMode = ui16Mode;
+}
+
+//*****************************************************************************
+//
+// Return the eQEP1 count in the given mode, starting the count if the mode
+// is new, and clear it afterwards if bClear is set.
+//
+//*****************************************************************************
+int32_t
+PulseCount(uint16_t ui16Mode, tBoolean bClear)
+{
+    int32_t i32Count;
+
+    if(ui16Mode != PULSE_MODE_COUNT)
+    {
+        ui16Mode = PULSE_MODE_QUADRATURE;
+    }
+    if(ui16Mode != g_ui16QepMode)
+    {
+        PulseQepStart(ui16Mode);
+    }
+
+    i32Count = (int32_t)EQep1Regs.QPOSCNT;
+    if(bClear)
+    {
+        EQep1Regs.QPOSCNT = 0;
+    }
+
+    return(i32Count);
+}
@@ -0,0 +1,35 @@
+//###########################################################################
+//
+// FILE:   pulse.h
+//
+// TITLE:  Frequency measurement and pulse counting by eCAP1 and eQEP1.
+//
+//###########################################################################
+
+#ifndef __PULSE_H__
+#define __PULSE_H__
+
+//*****************************************************************************
+//
+// The eQEP counting modes.  PULSE_MODE_QUADRATURE decodes an encoder on
+// GPIO20 (A) and GPIO21 (B), counting every edge of both.  PULSE_MODE_COUNT
+// counts the rising edges on GPIO20 alone.
+//
+//*****************************************************************************
+#define PULSE_MODE_QUADRATURE       0
+#define PULSE_MODE_COUNT            1
+
+//*****************************************************************************
+//
+// The longest period measured on GPIO19, in seconds.  A slower signal, or
+// none, reads as 0 Hz.
+//
+//*****************************************************************************
+#define PULSE_TIMEOUT_S             1
+
+extern void PulseInit(void);
+extern void PulseReset(void);
+extern float PulseFrequency(void);
+extern int32_t PulseCount(uint16_t ui16Mode, tBoolean bClear);
+
+#endif // __PULSE_H__
@@ -0,0 +1,333 @@
+//###########################################################################
+//
+// FILE:   pwm.c
+//
+// TITLE:  PWM outputs driven by the ePWM modules.
+//
+// A PWM tile hands its frequency and duty cycle to PwmSet() once per scan.
+// The period and compare values go to the shadow registers and are loaded
+// by the hardware at the next counter zero, so a change never cuts a cycle
+// short; the scan loop does no toggling of its own.  A channel takes its pin
+// from the GPIO on its first use and gives it back when the next program is
+// loaded.
+//
+// While the supervisor holds the outputs safe, a running channel is tripped
+// through its trip zone, which forces the pin to its safe level with the
+// PWM still muxed in.  The next PwmSet() from a running program releases it.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+#include "F2806x_Examples.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "pwm.h"
+
+//*****************************************************************************
+//
+// The largest TBCTL.CLKDIV, which divides the clock by 2 ^ CLKDIV, and the
+// largest TBPRD, one short of the maximum so that a compare of TBPRD + 1
+// still fits in CMPB.
+//
+//*****************************************************************************
+#define PWM_MAX_CLKDIV              7
+#define PWM_MAX_PERIOD              65534.0f
+
+//*****************************************************************************
+//
+// The pin mux setting that connects each channel's pin to its ePWM.
+//
+//*****************************************************************************
+#define PWM_GPIO44_MUX_EPWM7B       3
+#define PWM_GPIO3_MUX_EPWM2B        1
+
+//*****************************************************************************
+//
+// A channel's ePWM and the SetOutput() bit it replaces.
+//
+//*****************************************************************************
+typedef struct
+{
+    volatile struct EPWM_REGS *psRegs;
+    uint16_t ui16Output;
+}
+tPwmChannel;
+
+static const tPwmChannel g_psPwmChannels[PWM_NUM_CHANNELS] =
+{
+    { &EPwm7Regs, 0x01 },
+    { &EPwm2Regs, 0x02 }
+};
+
+//*****************************************************************************
+//
+// Whether each channel has its pin, and the time base it was last given so
+// that unchanged settings are not rewritten every scan.
+//
+//*****************************************************************************
+static tBoolean g_pbPwmRunning[PWM_NUM_CHANNELS];
+static uint16_t g_pui16PwmClkDiv[PWM_NUM_CHANNELS];
+static uint16_t g_pui16PwmPeriod[PWM_NUM_CHANNELS];
+static uint16_t g_pui16PwmCompare[PWM_NUM_CHANNELS];
+
+//*****************************************************************************
+//
+// Connect a channel's pin to its ePWM, or back to the GPIO.
+//
+//*****************************************************************************
+static void
+PwmMux(uint16_t ui16Channel, tBoolean bPwm)
+{
+    EALLOW;
+    if(ui16Channel == 0)
+    {
+        GpioCtrlRegs.GPBMUX1.bit.GPIO44 = bPwm ? PWM_GPIO44_MUX_EPWM7B : 0;
+    }
+    else
+    {
+        GpioCtrlRegs.GPAMUX1.bit.GPIO3 = bPwm ? PWM_GPIO3_MUX_EPWM2B : 0;
+    }
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Stop a channel's counter with its output low and hand its pin back to the
+// GPIO.
+//
+//*****************************************************************************
+static void
+PwmStop(uint16_t ui16Channel)
+{
+    volatile struct EPWM_REGS *psRegs;
+
+    psRegs = g_psPwmChannels[ui16Channel].psRegs;
+
+    PwmMux(ui16Channel, false);
+
+    psRegs->TBCTL.bit.CTRMODE = TB_FREEZE;
+    psRegs->TBCTR = 0;
+
+    EALLOW;
+    psRegs->TZCLR.bit.OST = 1;
+    EDIS;
+
+    g_pbPwmRunning[ui16Channel] = false;
+}
+
+//*****************************************************************************
+//
+// Start a channel with the given time base.  The first period is loaded
+// directly; every later one goes through the shadow registers.
+//
+// The output is set at counter zero and cleared when the counter reaches
+// CMPB.  A compare of 0 therefore holds the output low, since the compare
+// takes priority, and one of TBPRD + 1 holds it high.
+//
+//*****************************************************************************
+static void
+PwmStart(uint16_t ui16Channel, uint16_t ui16ClkDiv, uint16_t ui16Period,
+         uint16_t ui16Compare)
+{
+    volatile struct EPWM_REGS *psRegs;
+
+    psRegs = g_psPwmChannels[ui16Channel].psRegs;
+
+    psRegs->TBCTL.bit.CTRMODE = TB_FREEZE;
+    psRegs->TBCTL.bit.PHSEN = TB_DISABLE;
+    psRegs->TBCTL.bit.SYNCOSEL = TB_SYNC_DISABLE;
+    psRegs->TBCTL.bit.HSPCLKDIV = TB_DIV1;
+    psRegs->TBCTL.bit.CLKDIV = ui16ClkDiv;
+    psRegs->TBCTL.bit.PRDLD = TB_IMMEDIATE;
+    psRegs->TBPRD = ui16Period;
+    psRegs->TBCTR = 0;
+
+    psRegs->CMPCTL.bit.SHDWBMODE = CC_IMMEDIATE;
+    psRegs->CMPB = ui16Compare;
+
+    psRegs->AQCTLA.all = 0;
+    psRegs->AQCTLB.all = 0;
+    psRegs->AQCTLB.bit.ZRO = AQ_SET;
+    psRegs->AQCTLB.bit.CBU = AQ_CLEAR;
+
+    psRegs->TBCTL.bit.PRDLD = TB_SHADOW;
+    psRegs->CMPCTL.bit.SHDWBMODE = CC_SHADOW;
+    psRegs->CMPCTL.bit.LOADBMODE = CC_CTR_ZERO;
+
+    EALLOW;
+    psRegs->TZSEL.all = 0;
+    psRegs->TZCLR.bit.OST = 1;
+    EDIS;
+
+    psRegs->TBCTL.bit.CTRMODE = TB_COUNT_UP;
+    PwmMux(ui16Channel, true);
+
+    g_pbPwmRunning[ui16Channel] = true;
+}
+
+//*****************************************************************************
+//
+// Clock the ePWMs of the PWM channels.  The channels start on their first
+// PwmSet().
+//
+//*****************************************************************************
+void
+PwmInit(void)
+{
+    uint16_t ui16Channel;
+
+    EALLOW;
+    SysCtrlRegs.PCLKCR1.bit.EPWM2ENCLK = 1;
+    SysCtrlRegs.PCLKCR1.bit.EPWM7ENCLK = 1;
+    EDIS;
+
+    for(ui16Channel = 0; ui16Channel < PWM_NUM_CHANNELS; ui16Channel++)
+    {
+        PwmStop(ui16Channel);
+    }
+}
+
+//*****************************************************************************
+//
+// Stop every channel and give the pins back to SetOutput().  This is called
+// when a program is loaded.
+//
+//*****************************************************************************
+void
+PwmReset(void)
+{
+    uint16_t ui16Channel;
+
+    for(ui16Channel = 0; ui16Channel < PWM_NUM_CHANNELS; ui16Channel++)
+    {
+        if(g_pbPwmRunning[ui16Channel])
+        {
+            PwmStop(ui16Channel);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Set a channel's frequency in Hz and its duty cycle from 0 to 1, starting
+// it if need be.  The frequency is held to PWM_MIN_HZ to PWM_MAX_HZ.
+//
+// The clock divider is the smallest that fits the period in TBPRD, for the
+// finest duty cycle.  The divider itself is not shadowed, so a frequency
+// change that needs a new divider may stretch or shorten one cycle.
+//
+// \return Returns the duty cycle the channel was given, after rounding.
+//
+//*****************************************************************************
+float
+PwmSet(uint16_t ui16Channel, float fFrequency, float fDuty)
+{
+    volatile struct EPWM_REGS *psRegs;
+    float fClocks;
+    uint16_t ui16ClkDiv, ui16Period, ui16Compare;
+
+    if(ui16Channel >= PWM_NUM_CHANNELS)
+    {
+        return(0.0f);
+    }
+    psRegs = g_psPwmChannels[ui16Channel].psRegs;
+
+    if(!(fFrequency >= PWM_MIN_HZ))
+    {
+        fFrequency = PWM_MIN_HZ;
+    }
+    else if(fFrequency > PWM_MAX_HZ)
+    {
+        fFrequency = PWM_MAX_HZ;
+    }
+    if(!(fDuty >= 0.0f))
+    {
+        fDuty = 0.0f;
+    }
+    else if(fDuty > 1.0f)
+    {
+        fDuty = 1.0f;
+    }
+
+    fClocks = (float)SysCtlClockGet(SYSTEM_CLOCK_SPEED) / fFrequency;
+    for(ui16ClkDiv = 0; ui16ClkDiv < PWM_MAX_CLKDIV; ui16ClkDiv++)
+    {
+        if(fClocks <= PWM_MAX_PERIOD + 1.0f)
+        {
+            break;
+        }
+        fClocks *= 0.5f;
+    }
+    ui16Period = (uint16_t)(fClocks - 0.5f);
+    ui16Compare = (uint16_t)((fDuty * ((float)ui16Period + 1.0f)) + 0.5f);
+
+    if(!g_pbPwmRunning[ui16Channel])
+    {
+        PwmStart(ui16Channel, ui16ClkDiv, ui16Period, ui16Compare);
+    }
+    else
+    {
+        //
+        // Release a trip left by the supervisor, now that the program is
+        // in control again.
+        //
+        if(psRegs->TZFLG.bit.OST)
+        {
+            EALLOW;
+            psRegs->TZCLR.bit.OST = 1;
+            EDIS;
+        }
+
+        if(ui16ClkDiv != g_pui16PwmClkDiv[ui16Channel])
+        {
+            psRegs->TBCTL.bit.CLKDIV = ui16ClkDiv;
+        }
+        if(ui16Period != g_pui16PwmPeriod[ui16Channel])
+        {
+            psRegs->TBPRD = ui16Period;
+        }
+        if(ui16Compare != g_pui16PwmCompare[ui16Channel])
+        {
+            psRegs->CMPB = ui16Compare;
+        }
+    }
+
+    g_pui16PwmClkDiv[ui16Channel] = ui16ClkDiv;
+    g_pui16PwmPeriod[ui16Channel] = ui16Period;
+    g_pui16PwmCompare[ui16Channel] = ui16Compare;
+
+    return((float)ui16Compare / ((float)ui16Period + 1.0f));
+}
+
+//*****************************************************************************
+//
+// Force each running channel to its bit of the safe state ui16Outputs.
+// This is called by the supervisor, from the timer interrupt on an overrun.
+//
+//*****************************************************************************
+void
+PwmSafeOutputs(uint16_t ui16Outputs)
+{
+    volatile struct EPWM_REGS *psRegs;
+    uint16_t ui16Channel;
+
+    EALLOW;
+    for(ui16Channel = 0; ui16Channel < PWM_NUM_CHANNELS; ui16Channel++)
+    {
+        if(!g_pbPwmRunning[ui16Channel])
+        {
+            continue;
+        }
+        psRegs = g_psPwmChannels[ui16Channel].psRegs;
+
+        psRegs->TZCTL.bit.TZB =
+            (ui16Outputs & g_psPwmChannels[ui16Channel].ui16Output) ?
+            TZ_FORCE_HI : TZ_FORCE_LO;
+        psRegs->TZFRC.bit.OST = 1;
+    }
+    EDIS;
+}
@@ -0,0 +1,36 @@
+//###########################################################################
+//
+// FILE:   pwm.h
+//
+// TITLE:  PWM outputs driven by the ePWM modules.
+//
+//###########################################################################
+
+#ifndef __PWM_H__
+#define __PWM_H__
+
+//*****************************************************************************
+//
+// The PWM channels.  Channel 0 is output bit 0 (GPIO44, EPWM7B) and channel
+// 1 is output bit 1 (GPIO3, EPWM2B); none of the other output pins has an
+// ePWM function.
+//
+//*****************************************************************************
+#define PWM_NUM_CHANNELS            2
+
+//*****************************************************************************
+//
+// The frequency range in Hz.  Below PWM_MIN_HZ the period no longer fits in
+// TBPRD at the largest clock divider, and above PWM_MAX_HZ the duty cycle
+// has less than 1% resolution.
+//
+//*****************************************************************************
+#define PWM_MIN_HZ                  10.0f
+#define PWM_MAX_HZ                  800000.0f
+
+extern void PwmInit(void);
+extern void PwmReset(void);
+extern float PwmSet(uint16_t ui16Channel, float fFrequency, float fDuty);
+extern void PwmSafeOutputs(uint16_t ui16Outputs);
+
+#endif // __PWM_H__
@@ -0,0 +1,95 @@
+//###########################################################################
+//
+// FILE:   ring.c
+//
+// TITLE:  Single producer, single consumer ring buffers.
+//
+//###########################################################################
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "inc/hw_types.h"
+#include "ring.h"
+
+//*****************************************************************************
+//
+// Append an element.  Called by the producer only.
+//
+// The element is copied in before the head is advanced past it, so the
+// consumer never sees a partly written element.
+//
+// \return Returns \b false, and drops the element, if the ring is full.
+//
+//*****************************************************************************
+tBoolean
+RingWrite(tRing *psRing, const void *pvElement)
+{
+    uint16_t ui16Head, ui16Next;
+
+    ui16Head = psRing->ui16Head;
+    ui16Next = (ui16Head + 1) & (psRing->ui16Size - 1);
+
+    if(ui16Next == psRing->ui16Tail)
+    {
+        return(false);
+    }
+
+    memcpy((char *)psRing->pvBuffer + (ui16Head * psRing->ui16ElementSize),
+           pvElement, psRing->ui16ElementSize);
+
+    psRing->ui16Head = ui16Next;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Remove the oldest element.  Called by the consumer only.
+//
+// \return Returns \b false if the ring is empty.
+//
+//*****************************************************************************
+tBoolean
+RingRead(tRing *psRing, void *pvElement)
+{
+    uint16_t ui16Tail;
+
+    ui16Tail = psRing->ui16Tail;
+
+    if(ui16Tail == psRing->ui16Head)
+    {
+        return(false);
+    }
+
+    memcpy(pvElement,
+           (char *)psRing->pvBuffer + (ui16Tail * psRing->ui16ElementSize),
+           psRing->ui16ElementSize);
+
+    psRing->ui16Tail = (ui16Tail + 1) & (psRing->ui16Size - 1);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Return the number of elements waiting to be read.
+//
+//*****************************************************************************
+uint16_t
+RingUsed(const tRing *psRing)
+{
+    return((psRing->ui16Head - psRing->ui16Tail) & (psRing->ui16Size - 1));
+}
+
+//*****************************************************************************
+//
+// Return the number of elements that can be written before the ring is full.
+//
+//*****************************************************************************
+uint16_t
+RingFree(const tRing *psRing)
+{
+    return(psRing->ui16Size - 1 - RingUsed(psRing));
+}
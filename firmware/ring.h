@@ -0,0 +1,45 @@
+//###########################################################################
+//
+// FILE:   ring.h
+//
+// TITLE:  Single producer, single consumer ring buffers.
+//
+//###########################################################################
+
+#ifndef __RING_H__
+#define __RING_H__
+
+//*****************************************************************************
+//
+// A ring of fixed size elements passed from one interrupt to the foreground,
+// or the other way round.  Only the producer writes ui16Head and only the
+// consumer writes ui16Tail, so no locking is needed on a single core.  The
+// element count must be a power of two and one element is always left empty
+// to tell a full ring from an empty one.
+//
+//*****************************************************************************
+typedef struct
+{
+    void *pvBuffer;
+    uint16_t ui16ElementSize;
+    uint16_t ui16Size;
+    volatile uint16_t ui16Head;
+    volatile uint16_t ui16Tail;
+}
+tRing;
+
+//*****************************************************************************
+//
+// Static initializer for a ring over an array of elements.
+//
+//*****************************************************************************
+#define RING_INIT(psArray)                                                    \
+    { (psArray), sizeof((psArray)[0]),                                        \
+      sizeof(psArray) / sizeof((psArray)[0]), 0, 0 }
+
+extern tBoolean RingWrite(tRing *psRing, const void *pvElement);
+extern tBoolean RingRead(tRing *psRing, void *pvElement);
+extern uint16_t RingUsed(const tRing *psRing);
+extern uint16_t RingFree(const tRing *psRing);
+
+#endif // __RING_H__
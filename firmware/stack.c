@@ -0,0 +1,88 @@
+//###########################################################################
+//
+// FILE:   stack.c
+//
+// TITLE:  Stack high-water mark.
+//
+// The C28x stack grows up from __stack to __STACK_END.  Everything above the
+// caller of StackPaint() is filled with STACK_PAINT at boot, and the deepest
+// the stack has been since is found later by looking for the highest word
+// that no longer holds the pattern.
+//
+//###########################################################################
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "stack.h"
+
+//*****************************************************************************
+//
+// Words above the caller's locals left unpainted, to cover StackPaint()'s
+// own return address and frame.
+//
+//*****************************************************************************
+#define STACK_PAINT_MARGIN          16
+
+//*****************************************************************************
+//
+// Stack bounds, from the linker.
+//
+//*****************************************************************************
+extern uint16_t _stack[];
+extern uint16_t _STACK_END[];
+
+//*****************************************************************************
+//
+// Fill the unused part of the stack with STACK_PAINT.
+//
+// This must be called first thing in main(), before interrupts are enabled,
+// so that nothing above main()'s frame is in use.
+//
+//*****************************************************************************
+void
+StackPaint(void)
+{
+    volatile uint16_t ui16Marker;
+    uint16_t *pui16Word;
+
+    for(pui16Word = (uint16_t *)&ui16Marker + STACK_PAINT_MARGIN;
+        pui16Word < _STACK_END; pui16Word++)
+    {
+        *pui16Word = STACK_PAINT;
+    }
+}
+
+//*****************************************************************************
+//
+// Find the deepest the stack has been since StackPaint().
+//
+// \return Returns the number of words used, counted from the bottom of the
+// stack.  A value equal to StackSize() means the stack may have overflowed.
+//
+//*****************************************************************************
+uint16_t
+StackHighWater(void)
+{
+    const uint16_t *pui16Word;
+
+    pui16Word = _STACK_END;
+    while((pui16Word > _stack) && (pui16Word[-1] == STACK_PAINT))
+    {
+        pui16Word--;
+    }
+
+    return(pui16Word - _stack);
+}
+
+//*****************************************************************************
+//
+// The size of the stack in words, as set by --stack_size.
+//
+//*****************************************************************************
+uint16_t
+StackSize(void)
+{
+    return(_STACK_END - _stack);
+}
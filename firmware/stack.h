@@ -0,0 +1,24 @@
+//###########################################################################
+//
+// FILE:   stack.h
+//
+// TITLE:  Stack high-water mark.
+//
+//###########################################################################
+
+#ifndef __STACK_H__
+#define __STACK_H__
+
+//*****************************************************************************
+//
+// The pattern written to the unused stack at boot.  Words that still hold it
+// have never been reached by the stack.
+//
+//*****************************************************************************
+#define STACK_PAINT                 0x5AA5
+
+extern void StackPaint(void);
+extern uint16_t StackHighWater(void);
+extern uint16_t StackSize(void);
+
+#endif // __STACK_H__
@@ -0,0 +1,272 @@
+//###########################################################################
+//
+// FILE:   supervisor.c
+//
+// TITLE:  Scan supervision and safe outputs.
+//
+// Every scan is bracketed by SupervisorScanBegin() and SupervisorScanEnd().
+// The engine timer interrupt counts the ticks a scan has been running for
+// and, at the deadline, drives the outputs to the safe state and raises a
+// fault without waiting for the scan to return.  The watchdog is only
+// serviced by the main loop, so a hang that also stops the timer interrupt
+// resets the device instead, and is reported after the reset.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "inc/hw_types.h"
+#include "events.h"
+#include "pwm.h"
+#include "pattern.h"
+#include "supervisor.h"
+
+//*****************************************************************************
+//
+// The output pins, by SetOutput() bit, as masks of the GPIO A and B ports.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32PortA;
+    uint32_t ui32PortB;
+}
+tOutputPin;
+
+static const tOutputPin g_psOutputPins[8] =
+{
+    { 0,             1UL << (44 - 32) },
+    { 1UL << 3,      0 },
+    { 1UL << 16,     0 },
+    { 1UL << 17,     0 },
+    { 1UL << 13,     0 },
+    { 0,             1UL << (50 - 32) },
+    { 0,             1UL << (51 - 32) },
+    { 0,             1UL << (55 - 32) }
+};
+
+//*****************************************************************************
+//
+// The safe state, kept as the set and clear masks of each port so it can be
+// written from the interrupt with no further work.
+//
+//*****************************************************************************
+static uint16_t g_ui16SafeState = 0;
+static uint32_t g_ui32SafeSetA = 0;
+static uint32_t g_ui32SafeClearA = 0;
+static uint32_t g_ui32SafeSetB = 0;
+static uint32_t g_ui32SafeClearB = 0;
+
+//*****************************************************************************
+//
+// Scan progress, shared with the timer interrupt.
+//
+//*****************************************************************************
+static volatile tBoolean g_bScanActive = false;
+static volatile uint16_t g_ui16ScanTicks = 0;
+
+volatile uint16_t g_ui16SupervisorFaults = 0;
+uint16_t g_ui16SupervisorOverruns = 0;
+
+//*****************************************************************************
+//
+// Pet the watchdog.
+//
+// This is also handed to the flash API as its callback, so it is placed in
+// RAM with the flash routines.
+//
+//*****************************************************************************
+#pragma CODE_SECTION(SupervisorService, "ramfuncs");
+void
+SupervisorService(void)
+{
+    EALLOW;
+    SysCtrlRegs.WDKEY = 0x0055;
+    SysCtrlRegs.WDKEY = 0x00AA;
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Record a watchdog reset and leave the watchdog off until SupervisorStart().
+//
+// This must run before anything else writes WDCR, since that is where the
+// reset is flagged.
+//
+//*****************************************************************************
+void
+SupervisorInit(void)
+{
+    EALLOW;
+    if(SysCtrlRegs.WDCR & SUPERVISOR_WDCR_WDFLAG)
+    {
+        g_ui16SupervisorFaults |= SUPERVISOR_FAULT_WATCHDOG;
+    }
+    SysCtrlRegs.WDCR = SUPERVISOR_WDCR_WDFLAG | SUPERVISOR_WDCR_DISABLE;
+    EDIS;
+
+    SupervisorSetSafeState(0);
+}
+
+//*****************************************************************************
+//
+// Start the watchdog.  From here on the main loop must call
+// SupervisorService() or SupervisorScanEnd() at least every 52ms.
+//
+//*****************************************************************************
+void
+SupervisorStart(void)
+{
+    SupervisorService();
+
+    //
+    // Reset on timeout rather than raise WAKEINT.
+    //
+    EALLOW;
+    SysCtrlRegs.SCSR = 0;
+    SysCtrlRegs.WDCR = SUPERVISOR_WDCR_ENABLE;
+    EDIS;
+}
+
+//*****************************************************************************
+//
+// Bracket one scan of the program.
+//
+//*****************************************************************************
+void
+SupervisorScanBegin(void)
+{
+    g_ui16ScanTicks = 0;
+    g_bScanActive = true;
+}
+
+void
+SupervisorScanEnd(void)
+{
+    g_bScanActive = false;
+
+    SupervisorService();
+}
+
+//*****************************************************************************
+//
+// Check the scan deadline.  This is called from the engine timer interrupt.
+//
+//*****************************************************************************
+void
+SupervisorTick(void)
+{
+    if(!g_bScanActive || (++g_ui16ScanTicks < SUPERVISOR_SCAN_DEADLINE))
+    {
+        return;
+    }
+
+    g_bScanActive = false;
+
+    SupervisorOverrun();
+}
+
+//*****************************************************************************
+//
+// Raise an overrun fault and force the safe state.  This is called from the
+// engine timer interrupt, for a scan past its deadline or a timed task still
+// waiting or running when it is next due.
+//
+//*****************************************************************************
+void
+SupervisorOverrun(void)
+{
+    PatternStop();
+    SupervisorSafeOutputs();
+
+    g_ui16SupervisorFaults |= SUPERVISOR_FAULT_OVERRUN;
+    g_ui16SupervisorOverruns++;
+    EventPost(EVENT_FAULT);
+}
+
+//*****************************************************************************
+//
+// Return the port A and B pins of the outputs set in ui16Outputs, bit n of
+// which is output n as for SetOutput().
+//
+//*****************************************************************************
+void
+SupervisorOutputMasks(uint16_t ui16Outputs, uint32_t *pui32PortA,
+                      uint32_t *pui32PortB)
+{
+    uint16_t ui16Bit;
+
+    *pui32PortA = *pui32PortB = 0;
+
+    for(ui16Bit = 0; ui16Bit < 8; ui16Bit++)
+    {
+        if(ui16Outputs & (1 << ui16Bit))
+        {
+            *pui32PortA |= g_psOutputPins[ui16Bit].ui32PortA;
+            *pui32PortB |= g_psOutputPins[ui16Bit].ui32PortB;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Set the state the outputs are driven to when no program is in control.
+//
+//*****************************************************************************
+void
+SupervisorSetSafeState(uint16_t ui16Outputs)
+{
+    uint32_t ui32SetA, ui32SetB, ui32ClearA, ui32ClearB;
+    uint16_t ui16Status;
+
+    SupervisorOutputMasks(ui16Outputs, &ui32SetA, &ui32SetB);
+    SupervisorOutputMasks(~ui16Outputs, &ui32ClearA, &ui32ClearB);
+
+    //
+    // The timer interrupt may use the masks at any point.
+    //
+    ui16Status = __disable_interrupts();
+    g_ui16SafeState = ui16Outputs & 0xFF;
+    g_ui32SafeSetA = ui32SetA;
+    g_ui32SafeClearA = ui32ClearA;
+    g_ui32SafeSetB = ui32SetB;
+    g_ui32SafeClearB = ui32ClearB;
+    __restore_interrupts(ui16Status);
+}
+
+uint16_t
+SupervisorGetSafeState(void)
+{
+    return(g_ui16SafeState);
+}
+
+//*****************************************************************************
+//
+// Drive all eight outputs to the safe state, with one masked write to each
+// set and clear register.  Outputs running as PWM are forced by their ePWM,
+// and outputs held by a playing pattern are left to it.
+//
+//*****************************************************************************
+void
+SupervisorSafeOutputs(void)
+{
+    GpioDataRegs.GPACLEAR.all = g_ui32SafeClearA & ~g_ui32PatternPinsA;
+    GpioDataRegs.GPASET.all = g_ui32SafeSetA & ~g_ui32PatternPinsA;
+    GpioDataRegs.GPBCLEAR.all = g_ui32SafeClearB & ~g_ui32PatternPinsB;
+    GpioDataRegs.GPBSET.all = g_ui32SafeSetB & ~g_ui32PatternPinsB;
+    PwmSafeOutputs(g_ui16SafeState);
+}
+
+//*****************************************************************************
+//
+// Hand the outputs back to the program.
+//
+//*****************************************************************************
+void
+SupervisorClearFaults(void)
+{
+    g_ui16SupervisorFaults = 0;
+}
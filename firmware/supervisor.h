@@ -0,0 +1,52 @@
+//###########################################################################
+//
+// FILE:   supervisor.h
+//
+// TITLE:  Scan supervision and safe outputs.
+//
+//###########################################################################
+
+#ifndef __SUPERVISOR_H__
+#define __SUPERVISOR_H__
+
+//*****************************************************************************
+//
+// A scan that has not finished after SUPERVISOR_SCAN_DEADLINE ticks of the
+// engine timebase is an overrun, as is a timed task that has not finished
+// by the time it is next due.  The watchdog, serviced once per completed
+// scan, resets the device after about 52ms (OSCCLK / 512 / 8, 256 counts)
+// if even the overrun handling fails.
+//
+//*****************************************************************************
+#define SUPERVISOR_SCAN_DEADLINE    10
+#define SUPERVISOR_WDCR_ENABLE      0x002C
+#define SUPERVISOR_WDCR_DISABLE     0x0068
+#define SUPERVISOR_WDCR_WDFLAG      0x0080
+
+//*****************************************************************************
+//
+// Fault flags.  A fault holds the outputs in the safe state until the host
+// clears it.
+//
+//*****************************************************************************
+#define SUPERVISOR_FAULT_OVERRUN    0x0001
+#define SUPERVISOR_FAULT_WATCHDOG   0x0002
+
+extern volatile uint16_t g_ui16SupervisorFaults;
+extern uint16_t g_ui16SupervisorOverruns;
+
+extern void SupervisorInit(void);
+extern void SupervisorStart(void);
+extern void SupervisorService(void);
+extern void SupervisorScanBegin(void);
+extern void SupervisorScanEnd(void);
+extern void SupervisorTick(void);
+extern void SupervisorOverrun(void);
+extern void SupervisorOutputMasks(uint16_t ui16Outputs, uint32_t *pui32PortA,
+                                  uint32_t *pui32PortB);
+extern void SupervisorSetSafeState(uint16_t ui16Outputs);
+extern uint16_t SupervisorGetSafeState(void);
+extern void SupervisorSafeOutputs(void);
+extern void SupervisorClearFaults(void);
+
+#endif // __SUPERVISOR_H__
@@ -0,0 +1,568 @@
+//###########################################################################
+//
+// FILE:   tiles.c
+//
+// TITLE:  Native tile handlers.
+//
+// Each function here implements one library function.  To add a tile, add
+// its entry to a .lib file in software/lib/, write a handler here with the
+// same name as the library function and rerun software/gen_opcodes.py.
+//
+//###########################################################################
+
+#include "F2806x_Device.h"
+
+#include <stdint.h>
+
+#include "opcodes.h"
+#include "engine.h"
+#include "capture.h"
+#include "analog.h"
+#include "pwm.h"
+#include "pulse.h"
+#include "expansion.h"
+#include "cla.h"
+#include "supervisor.h"
+#include "pattern.h"
+
+int HexConstant(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0];
+}
+
+int SetOutput(const int *piInputs, uint16_t ui16Count, int *piState){
+	int inputBits = piInputs[0];
+	uint32_t set_a, set_b, clear_a, clear_b;
+
+	// An overrun has already put the outputs in the safe state
+	if (g_ui16SupervisorFaults){
+		return inputBits;
+	}
+
+	SupervisorOutputMasks(inputBits, &set_a, &set_b);
+	SupervisorOutputMasks(~inputBits, &clear_a, &clear_b);
+
+	// Pins a running pattern owns are left to it, and each port is written
+	// whole, so the outputs change together
+	GpioDataRegs.GPACLEAR.all = clear_a & ~g_ui32PatternPinsA;
+	GpioDataRegs.GPASET.all = set_a & ~g_ui32PatternPinsA;
+	GpioDataRegs.GPBCLEAR.all = clear_b & ~g_ui32PatternPinsB;
+	GpioDataRegs.GPBSET.all = set_b & ~g_ui32PatternPinsB;
+
+	return inputBits;
+}
+
+int ReadInput(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	int outputBits = 0;
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO1) << 7);
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO19) << 6);
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO0) << 5);
+	outputBits |= ((GpioDataRegs.GPBDAT.bit.GPIO32) << 4);
+	outputBits |= ((GpioDataRegs.GPBDAT.bit.GPIO33) << 3);
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO22) << 2);
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO18) << 1);
+	outputBits |= ((GpioDataRegs.GPADAT.bit.GPIO12));
+
+	return outputBits;
+}
+
+//
+// Add-on board I/O.  The expansion bus is shifted once per scan, so these
+// only read and write the bytes it carries.
+//
+int ExpansionInput(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	return ExpansionRead(piInputs[0]);
+}
+
+int ExpansionOutput(const int *piInputs, uint16_t ui16Count, int *piState){
+	int inputBits = piInputs[1];
+
+	// The main loop turns the expansion outputs off after an overrun
+	if (g_ui16SupervisorFaults){
+		return inputBits;
+	}
+
+	ExpansionWrite(piInputs[0], inputBits);
+	return inputBits;
+}
+
+//
+// Edges latched by the input capture interrupts since the last scan, so
+// pulses shorter than a scan are not missed.
+//
+int CapturedRising(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	return g_ui16CaptureRising;
+}
+
+int CapturedFalling(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	return g_ui16CaptureFalling;
+}
+
+int AnalogInput(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	// The DMA keeps the samples current; this only averages the newest
+	return AnalogRead(piInputs[0]);
+}
+
+int OctalShiftLeft(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] << 1;
+    return outputBits;
+}
+
+int OctalShiftRight(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] >> 1;
+    return outputBits;
+}
+
+int OctalAND(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] & piInputs[1];
+    return outputBits;
+}
+
+int MultiAND(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0];
+    uint16_t n;
+
+    for(n = 1; n < ui16Count; n++){
+        outputBits &= piInputs[n];
+    }
+    return outputBits;
+}
+
+int MultiOR(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0];
+    uint16_t n;
+
+    for(n = 1; n < ui16Count; n++){
+        outputBits |= piInputs[n];
+    }
+    return outputBits;
+}
+
+int MultiXOR(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0];
+    uint16_t n;
+
+    for(n = 1; n < ui16Count; n++){
+        outputBits ^= piInputs[n];
+    }
+    return outputBits;
+}
+
+int MultiADD(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int sum = piInputs[0];
+    uint16_t n;
+
+    for(n = 1; n < ui16Count; n++){
+        sum += piInputs[n];
+    }
+    return sum;
+}
+
+int OctalOR(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] | piInputs[1];
+    return outputBits;
+}
+
+int OctalXOR(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] ^ piInputs[1];
+    return outputBits;
+}
+
+int OctalNOT(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = ~piInputs[0] & 0xFF;
+    return outputBits;
+}
+
+//
+// Edge detectors output the bits that changed since the last scan.
+// piState[0] is the input seen on the previous scan.
+//
+int RisingEdge(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = piInputs[0] & ~piState[0];
+    piState[0] = piInputs[0];
+    return outputBits;
+}
+
+int FallingEdge(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    int outputBits = ~piInputs[0] & piState[0];
+    piState[0] = piInputs[0];
+    return outputBits;
+}
+
+int Add(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0] + piInputs[1];
+}
+
+int Subtract(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0] - piInputs[1];
+}
+
+int GreaterThan(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0] > piInputs[1];
+}
+
+int LessThan(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0] < piInputs[1];
+}
+
+int Equal(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    return piInputs[0] == piInputs[1];
+}
+
+//
+// Timers count scan time in milliseconds.  piState[0] is the time
+// accumulated so far, held at the preset so it cannot wrap.
+//
+static int TimerAccumulate(int *piState, int preset){
+
+    if (piState[0] < preset){
+        if (g_ui16ScanElapsed >= (uint16_t)(preset - piState[0])){
+            piState[0] = preset;
+        }
+        else{
+            piState[0] += g_ui16ScanElapsed;
+        }
+    }
+    return piState[0] >= preset;
+}
+
+int OnDelay(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    if (!piInputs[0]){
+        piState[0] = 0;
+        return 0;
+    }
+    return TimerAccumulate(piState, piInputs[1]);
+}
+
+int OffDelay(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    if (piInputs[0]){
+        piState[0] = 0;
+        return 1;
+    }
+    return !TimerAccumulate(piState, piInputs[1]);
+}
+
+//
+// Counts rising edges of the count input until reset is non-zero.
+// piState[0] is the previous count input and piState[1] the count.
+//
+int Counter(const int *piInputs, uint16_t ui16Count, int *piState){
+
+    if (piInputs[1]){
+        piState[1] = 0;
+    }
+    else if (piInputs[0] && !piState[0] && (piState[1] < 0x7FFF)){
+        piState[1]++;
+    }
+    piState[0] = piInputs[0];
+    return piState[1];
+}
+
+//
+// CLA tiles.  These only hand their inputs to the CLA, which runs them all
+// at the end of the scan; piState[0] is the CLA job the engine gave them.
+//
+int MovingAverage(const int *piInputs, uint16_t ui16Count, int *piState){
+	int inputs[2];
+
+	inputs[0] = piInputs[0];
+	inputs[1] = piInputs[1];
+	if (inputs[1] < 1){
+		inputs[1] = 1;
+	}
+	else if (inputs[1] > CLA_HISTORY){
+		inputs[1] = CLA_HISTORY;
+	}
+	return ClaSubmit(piState[0], CLA_FN_AVERAGE, inputs, 2);
+}
+
+int FIRFilter(const int *piInputs, uint16_t ui16Count, int *piState){
+
+	return ClaSubmit(piState[0], CLA_FN_FIR, piInputs, ui16Count);
+}
+
+int Scale(const int *piInputs, uint16_t ui16Count, int *piState){
+	int inputs[4];
+
+	inputs[0] = piInputs[0];
+	inputs[1] = piInputs[1];
+	inputs[2] = piInputs[2] ? piInputs[2] : 1;
+	inputs[3] = piInputs[3];
+	return ClaSubmit(piState[0], CLA_FN_SCALE, inputs, 4);
+}
+
+//
+// Typed tiles.  These see every value as a tValue and use the member their
+// library declares: i32 for int32 and iq, f32 for float.  Fixed point is
+// Q16 (OPCODE_IQ_Q), multiplied with the compiler's IQ intrinsic.
+//
+#define IQ_ONE ((int32_t)1 << OPCODE_IQ_Q)
+
+static tValue Int32Value(int32_t value){
+	tValue result;
+
+	result.i32 = value;
+	return result;
+}
+
+static tValue FloatValue(float value){
+	tValue result;
+
+	result.f32 = value;
+	return result;
+}
+
+static int32_t Saturate16(int32_t value){
+
+	if (value > 32767){
+		return 32767;
+	}
+	if (value < -32768){
+		return -32768;
+	}
+	return value;
+}
+
+static int32_t RoundFloat(float value, float limit){
+
+	if (value >= limit){
+		return (int32_t)limit;
+	}
+	if (value <= -limit){
+		return -(int32_t)limit;
+	}
+	return (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+tValue Constant32(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return psInputs[0];
+}
+
+tValue Add32(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 + psInputs[1].i32);
+}
+
+tValue Subtract32(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 - psInputs[1].i32);
+}
+
+tValue Multiply32(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 * psInputs[1].i32);
+}
+
+tValue ConstantIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return psInputs[0];
+}
+
+tValue AddIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 + psInputs[1].i32);
+}
+
+tValue SubtractIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 - psInputs[1].i32);
+}
+
+tValue MultiplyIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(__IQmpy(psInputs[0].i32, psInputs[1].i32, OPCODE_IQ_Q));
+}
+
+tValue ConstantF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return psInputs[0];
+}
+
+tValue AddF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue(psInputs[0].f32 + psInputs[1].f32);
+}
+
+tValue SubtractF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue(psInputs[0].f32 - psInputs[1].f32);
+}
+
+tValue MultiplyF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue(psInputs[0].f32 * psInputs[1].f32);
+}
+
+tValue DivideF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	if (psInputs[1].f32 == 0.0f){
+		return FloatValue(0.0f);
+	}
+	return FloatValue(psInputs[0].f32 / psInputs[1].f32);
+}
+
+tValue GreaterThanF(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].f32 > psInputs[1].f32);
+}
+
+tValue IntToInt32(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return psInputs[0];
+}
+
+tValue Int32ToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(Saturate16(psInputs[0].i32));
+}
+
+tValue IntToIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(psInputs[0].i32 * IQ_ONE);
+}
+
+tValue IQToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	// Round half up by the bit below the point, as adding half a unit
+	// first would overflow near the top of the range
+	return Int32Value(Saturate16((psInputs[0].i32 >> OPCODE_IQ_Q) +
+	                             ((psInputs[0].i32 >> (OPCODE_IQ_Q - 1)) & 1)));
+}
+
+tValue IntToFloat(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue((float)psInputs[0].i32);
+}
+
+tValue FloatToInt(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(RoundFloat(psInputs[0].f32, 32767.0f));
+}
+
+tValue IQToFloat(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue((float)psInputs[0].i32 * (1.0f / IQ_ONE));
+}
+
+tValue FloatToIQ(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(RoundFloat(psInputs[0].f32 * IQ_ONE, 2147483520.0f));
+}
+
+//
+// PID control.  The loop runs once every period milliseconds of scan time,
+// so its gains see a fixed sample time however long the scans take; between
+// runs it holds its output.  The derivative acts on the measurement, so a
+// setpoint step does not kick the output, and the integral is clamped to
+// the output limits so it cannot wind up while the output is saturated.
+//
+// psState[0] is the integral, [1] the previous measurement, [2] the output,
+// [3] the scan time accumulated towards the next run and [4] non-zero once
+// the loop has run.
+//
+static float ClampFloat(float value, float min, float max){
+
+	if (value > max){
+		return max;
+	}
+	if (value < min){
+		return min;
+	}
+	return value;
+}
+
+tValue PID(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+	float setpoint = psInputs[0].f32;
+	float measurement = psInputs[1].f32;
+	float kp = psInputs[2].f32;
+	float ki = psInputs[3].f32;
+	float kd = psInputs[4].f32;
+	float out_min = psInputs[5].f32;
+	float out_max = psInputs[6].f32;
+	int32_t period = psInputs[7].i32 > 0 ? psInputs[7].i32 : 1;
+	float dt, error, derivative;
+
+	psState[3].i32 += g_ui16ScanElapsed;
+	if (psState[3].i32 < period){
+		return psState[2];
+	}
+
+	//
+	// A late scan runs the loop once, not once per missed period, and
+	// the one after that is on time again.
+	//
+	psState[3].i32 -= period;
+	if (psState[3].i32 >= period){
+		psState[3].i32 = 0;
+	}
+
+	if (!psState[4].i32){
+		psState[1].f32 = measurement;
+		psState[4].i32 = 1;
+	}
+
+	dt = (float)period * (1.0f / ENGINE_TICK_HZ);
+	error = setpoint - measurement;
+	derivative = (measurement - psState[1].f32) / dt;
+	psState[1].f32 = measurement;
+
+	psState[0].f32 = ClampFloat(psState[0].f32 + ki * error * dt,
+	                            out_min, out_max);
+	psState[2].f32 = ClampFloat(kp * error + psState[0].f32 - kd * derivative,
+	                            out_min, out_max);
+	return psState[2];
+}
+
+//
+// PWM outputs.  The ePWM keeps the pin running between scans; the tile only
+// passes on the frequency and duty cycle, which the hardware picks up at the
+// start of its next cycle.
+//
+tValue PWMOutput(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	// An overrun has already put the outputs in the safe state
+	if (g_ui16SupervisorFaults){
+		return psInputs[2];
+	}
+	return FloatValue(PwmSet((uint16_t)psInputs[0].i32, psInputs[1].f32,
+	                         psInputs[2].f32));
+}
+
+//
+// Pulse inputs.  eCAP1 and eQEP1 see every edge; these tiles only read what
+// they have measured.
+//
+tValue InputFrequency(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return FloatValue(PulseFrequency());
+}
+
+tValue EncoderCount(const tValue *psInputs, uint16_t ui16Count, tValue *psState){
+
+	return Int32Value(PulseCount((uint16_t)psInputs[0].i32, psInputs[1].i32 != 0));
+}
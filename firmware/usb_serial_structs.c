@@ -168,7 +168,7 @@ tUSBDCDCDevice g_sCDCDevice =
 // Receive buffer (from the USB perspective).
 //
 //*****************************************************************************
-uint8_t g_pi8USBRxBuffer[UART_BUFFER_SIZE];
+uint8_t g_pui8USBRxBuffer[USB_RX_BUFFER_SIZE];
 uint8_t g_pui8RxBufferWorkspace[USB_BUFFER_WORKSPACE_SIZE];
 const tUSBBuffer g_sRxBuffer =
 {
@@ -178,8 +178,8 @@ const tUSBBuffer g_sRxBuffer =
     USBDCDCPacketRead,              // pfnTransfer
     USBDCDCRxPacketAvailable,       // pfnAvailable
     (void *)&g_sCDCDevice,          // pvHandle
-    g_pi8USBRxBuffer,               // pi8Buffer
-    UART_BUFFER_SIZE,               // ui32BufferSize
+    g_pui8USBRxBuffer,              // pi8Buffer
+    USB_RX_BUFFER_SIZE,             // ui32BufferSize
     g_pui8RxBufferWorkspace         // pvWorkspace
 };
 //*****************************************************************************
@@ -187,7 +187,7 @@ const tUSBBuffer g_sRxBuffer =
 // Transmit buffer (from the USB perspective).
 //
 //*****************************************************************************
-uint8_t g_pi8USBTxBuffer[UART_BUFFER_SIZE];
+uint8_t g_pui8USBTxBuffer[USB_TX_BUFFER_SIZE];
 uint8_t g_pui8TxBufferWorkspace[USB_BUFFER_WORKSPACE_SIZE];
 const tUSBBuffer g_sTxBuffer =
 {
@@ -197,7 +197,7 @@ const tUSBBuffer g_sTxBuffer =
     USBDCDCPacketWrite,             // pfnTransfer
     USBDCDCTxPacketAvailable,       // pfnAvailable
     (void *)&g_sCDCDevice,          // pvHandle
-    g_pi8USBTxBuffer,               // pi8Buffer
-    UART_BUFFER_SIZE,               // ui32BufferSize
+    g_pui8USBTxBuffer,              // pi8Buffer
+    USB_TX_BUFFER_SIZE,             // ui32BufferSize
     g_pui8TxBufferWorkspace         // pvWorkspace
 };
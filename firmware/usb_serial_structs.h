@@ -16,13 +16,31 @@
 
 //*****************************************************************************
 //
-// The size of the transmit and receive buffers used for the redirected UART.
-// This number should be a power of 2 for best performance.  256 is chosen
-// pretty much at random though the buffer should be at least twice the size of
-// a maxmum-sized USB packet.
+// The size of the transmit and receive buffers.  Either can be overridden at
+// build time with --define.  Both must be a whole number of maximum-sized USB
+// packets, at least two, so a packet is never split at the end of the ring.
+// The transmit buffer is larger since it carries streamed values.
 //
 //*****************************************************************************
-#define UART_BUFFER_SIZE 256
+#define USB_PACKET_SIZE 64
+
+#ifndef USB_TX_BUFFER_SIZE
+#define USB_TX_BUFFER_SIZE 1024
+#endif
+
+#ifndef USB_RX_BUFFER_SIZE
+#define USB_RX_BUFFER_SIZE 256
+#endif
+
+#if (USB_TX_BUFFER_SIZE % USB_PACKET_SIZE) || \
+    (USB_TX_BUFFER_SIZE < (2 * USB_PACKET_SIZE))
+#error "USB_TX_BUFFER_SIZE must be a multiple of USB_PACKET_SIZE"
+#endif
+
+#if (USB_RX_BUFFER_SIZE % USB_PACKET_SIZE) || \
+    (USB_RX_BUFFER_SIZE < (2 * USB_PACKET_SIZE))
+#error "USB_RX_BUFFER_SIZE must be a multiple of USB_PACKET_SIZE"
+#endif
 
 extern uint32_t RxHandler(void *pvCBData, uint32_t ui32Event,
                                uint32_t ui32MsgValue, void *pvMsgData);
@@ -0,0 +1,204 @@
+""" Generates the firmware opcode table (firmware/opcode_table.c) and the
+    matching host-side descriptor (utils/opcodes.py) from the tile
+    libraries in lib/
+
+    The firmware build runs this as its pre-build step, so the table and
+    the descriptor follow the libraries. Run it by hand after changing a
+    library to update the host without building the firmware:
+        python gen_opcodes.py
+"""
+import os, sys
+
+SOFTWARE_DIR = os.path.dirname(os.path.abspath(__file__))
+LIB_DIR = os.path.join(SOFTWARE_DIR, 'lib')
+FIRMWARE_TABLE = os.path.join(SOFTWARE_DIR, '..', 'firmware', 'opcode_table.c')
+HOST_DESCRIPTOR = os.path.join(SOFTWARE_DIR, 'utils', 'opcodes.py')
+
+# Functions from this code up run on the CLA, see firmware/opcodes.h
+CLA_BASE = 0xE000
+
+# Functions that read state the background scan rebuilds, so only the
+# background task may use them, see OPCODE_FLAG_BACKGROUND
+BACKGROUND_ONLY = {'CapturedRising', 'CapturedFalling'}
+
+# Value types, see firmware/opcodes.h. Each has a connected kind and a
+# "set" kind for values fixed at compile time
+TYPES = {
+    'int': 'OPCODE_TYPE_INT16', 'set': 'OPCODE_TYPE_INT16',
+    'int32': 'OPCODE_TYPE_INT32', 'set32': 'OPCODE_TYPE_INT32',
+    'iq': 'OPCODE_TYPE_IQ', 'setiq': 'OPCODE_TYPE_IQ',
+    'float': 'OPCODE_TYPE_FLOAT', 'setf': 'OPCODE_TYPE_FLOAT',
+}
+TYPE_CODES = {'OPCODE_TYPE_INT16': 0, 'OPCODE_TYPE_INT32': 1,
+              'OPCODE_TYPE_IQ': 2, 'OPCODE_TYPE_FLOAT': 3}
+TYPE_BITS = 2
+
+
+def write_if_changed(file_path, text):
+    """ Writes a generated file only when its text changes, so that the
+        pre-build step does not make the firmware rebuild every time
+    """
+
+    try:
+        with open(file_path, newline='\n') as f:
+            if f.read() == text:
+                return
+    except IOError:
+        pass
+    with open(file_path, 'w', newline='\n') as f:
+        f.write(text)
+
+
+def is_set(kind):
+    """ True for the kinds of inputs fixed at compile time """
+    return kind.startswith('set')
+
+
+def uses_values(func):
+    """ True if the function needs a value handler rather than an int one """
+    kinds = [kind for name, kind in func['inputs'] + func['outputs']]
+    return any(TYPES.get(kind, '') != 'OPCODE_TYPE_INT16' for kind in kinds)
+
+
+def parse_lib(file_path):
+    """ Parses a .lib file the same way Workspace.add_library() does
+        Parameters
+            file_path: The path to the .lib file
+
+        Returns
+            functions: A list of dicts, one per library function
+    """
+
+    with open(file_path) as f:
+        lines = [line.rstrip('\r\n') for line in f]
+
+    num_of_funcs = int(lines[1])
+    i = 3
+    functions = []
+    for _ in range(num_of_funcs):
+        func = {}
+        func['name'] = lines[i].replace('#', '')
+        func['code'] = int(lines[i + 1], 16)
+        func['lib'] = os.path.basename(file_path)
+        i += 2
+
+        func['inputs'] = []
+        func['variadic'] = False
+        while lines[i][0] == 'i':
+            name, kind = lines[i].split(' ')[1:3]
+            if kind.endswith('...'):
+                kind = kind[:-3]
+                func['variadic'] = True
+            if kind not in TYPES:
+                sys.exit("%s: %s input %s has unknown type %s"
+                         % (file_path, func['name'], name, kind))
+            func['inputs'].append((name, kind))
+            i += 1
+        func['outputs'] = []
+        while lines[i][0] == 'o':
+            func['outputs'].append(tuple(lines[i].split(' ')[1:3]))
+            i += 1
+        func['states'] = []
+        while lines[i][0] == 's':
+            func['states'].append(tuple(lines[i].split(' ')[1:3]))
+            i += 1
+
+        # Skip the tool tip and icon path
+        i += 2
+        functions.append(func)
+
+    return functions
+
+
+def write_firmware_table(functions):
+    """ Writes the C opcode table, sorted by code for OpcodeFind() """
+
+    text = "//" + "#" * 75 + "\n"
+    text += "//\n"
+    text += "// FILE:   opcode_table.c\n"
+    text += "//\n"
+    text += "// TITLE:  Tile opcode registration table.\n"
+    text += "//\n"
+    text += "// Automatically generated by software/gen_opcodes.py from the\n"
+    text += "// libraries in software/lib/.  Do not edit!\n"
+    text += "//\n"
+    text += "//" + "#" * 75 + "\n\n"
+    text += "#include <stdint.h>\n\n"
+    text += "#include \"opcodes.h\"\n\n"
+
+    for func in functions:
+        if uses_values(func):
+            text += ("extern tValue %s(const tValue *psInputs, "
+                     "uint16_t ui16Count, tValue *psState);\n"
+                     % func['name'])
+        else:
+            text += ("extern int %s(const int *piInputs, "
+                     "uint16_t ui16Count, int *piState);\n" % func['name'])
+
+    text += "\nconst tOpcode g_psOpcodes[] =\n{\n"
+    for func in functions:
+        set_mask = 0
+        input_types = 0
+        for n, (name, kind) in enumerate(func['inputs']):
+            if is_set(kind):
+                set_mask |= 1 << n
+            input_types |= TYPE_CODES[TYPES[kind]] << (n * TYPE_BITS)
+        output_type = TYPES[func['outputs'][0][1]] if func['outputs'] \
+            else 'OPCODE_TYPE_INT16'
+        handlers = ("0, %s" if uses_values(func) else "%s, 0") % func['name']
+        flags = []
+        if func['variadic']:
+            flags.append("OPCODE_FLAG_VARIADIC")
+        if func['code'] >= CLA_BASE:
+            flags.append("OPCODE_FLAG_CLA")
+        if func['name'] in BACKGROUND_ONLY:
+            flags.append("OPCODE_FLAG_BACKGROUND")
+        text += "    // %s, %s\n" % (func['name'], func['lib'])
+        text += ("    { 0x%04X, %d, 0x%04X, %s, %d, 0x%08X, %s,\n"
+                 "      %s },\n"
+                 % (func['code'], len(func['inputs']), set_mask,
+                    " | ".join(flags) or "0", len(func['states']),
+                    input_types, output_type, handlers))
+    text += "};\n\n"
+    text += "const uint16_t g_ui16NumOpcodes = sizeof(g_psOpcodes) /\n"
+    text += "                                  sizeof(g_psOpcodes[0]);\n"
+
+    write_if_changed(FIRMWARE_TABLE, text)
+
+
+def write_host_descriptor(functions):
+    """ Writes the Python descriptor used by the compiler """
+
+    text = "# Automatically generated by gen_opcodes.py from the libraries in\n"
+    text += "# lib/.  Do not edit!\n\n"
+    text += "OPCODES = {\n"
+    for func in functions:
+        text += "    '0x%04X': {\n" % func['code']
+        text += "        'name': %r,\n" % func['name']
+        text += "        'inputs': %r,\n" % func['inputs']
+        text += "        'variadic': %r,\n" % func['variadic']
+        text += "        'outputs': %r,\n" % func['outputs']
+        text += "        'states': %r,\n" % func['states']
+        text += "        'background': %r,\n" % (func['name'] in
+                                                BACKGROUND_ONLY)
+        text += "    },\n"
+    text += "}\n"
+
+    write_if_changed(HOST_DESCRIPTOR, text)
+
+
+if __name__ == '__main__':
+
+    functions = []
+    for name in sorted(os.listdir(LIB_DIR)):
+        if name.endswith('.lib'):
+            functions += parse_lib(os.path.join(LIB_DIR, name))
+
+    functions.sort(key=lambda func: func['code'])
+    for a, b in zip(functions, functions[1:]):
+        if a['code'] == b['code']:
+            sys.exit("Duplicate FunctionReference 0x%04X (%s, %s)"
+                     % (a['code'], a['name'], b['name']))
+
+    write_firmware_table(functions)
+    write_host_descriptor(functions)
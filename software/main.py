@@ -3,6 +3,7 @@ from PyQt4 import QtGui, QtCore
 from widgets.resources import BrowseWidget
 from widgets.manager import WorkspaceManager
 from widgets.workspace import Workspace
+from widgets.analyser import LogicAnalyser
 from utils import fileop, ser_con, fedit
 
 
@@ -122,6 +123,11 @@ class main_app(QtGui.QMainWindow):
         compile_program.triggered.connect(
                 lambda: fileop.compile_program(self, self.work_path, self.workspace))
 
+        # Show the logic analyser
+        logic_analyser = QtGui.QAction('Logic Analyser', self)
+        logic_analyser.setStatusTip('Capture the board inputs as traces')
+        logic_analyser.triggered.connect(self.show_logic_analyser)
+
         # Add a tile to the drag and drop editor
         add_tile = QtGui.QAction(
                 QtGui.QIcon('img/add_tile.png'), 'Add Tile', self)
@@ -131,6 +137,18 @@ class main_app(QtGui.QMainWindow):
         add_tile.triggered.connect(
                 lambda: fedit.add_tile(self.workspace))
 
+        # Set the period and priority of a timed task
+        edit_task = QtGui.QAction('Edit Task', self)
+        edit_task.setStatusTip('Set the period and priority of a timed task')
+        edit_task.triggered.connect(
+                lambda: fedit.edit_task(self.workspace))
+
+        # Move tiles to a task
+        assign_task = QtGui.QAction('Assign Task', self)
+        assign_task.setStatusTip('Move a tile and the tiles feeding it to a task')
+        assign_task.triggered.connect(
+                lambda: fedit.assign_task(self.workspace))
+
         # Create file menu
         file_menu = menubar.addMenu('&File')
         new_menu = file_menu.addMenu('&New')
@@ -148,10 +166,13 @@ class main_app(QtGui.QMainWindow):
         connect_menu.addAction(compile_program)
         connect_menu.addAction(board_connect)
         connect_menu.addAction(upload)
+        connect_menu.addAction(logic_analyser)
 
 
         editor_menu = menubar.addMenu('&Editor')
         editor_menu.addAction(add_tile)
+        editor_menu.addAction(edit_task)
+        editor_menu.addAction(assign_task)
 
         # Create toolbars
         icon_size = QtCore.QSize(20, 20)
@@ -172,6 +193,11 @@ class main_app(QtGui.QMainWindow):
         editor_tool_bar.setIconSize(icon_size)
         editor_tool_bar.addAction(add_tile)
 
+    def show_logic_analyser(self):
+        """ Opens the logic analyser in a dock widget along the bottom """
+
+        self.logic_analyser_wrap.show()
+
     def update_workspace(self, new_path):
         """ Changes the current workspace path variable and file structure
             in the file_browser dock widget
@@ -206,10 +232,19 @@ class main_app(QtGui.QMainWindow):
         workspace_change = QtGui.QDockWidget('Manage Workspace', self)
         workspace_change.setWidget(self.work_manager)
 
+        # Initialize the logic analyser, hidden until it is asked for
+        # LogicAnalyser() is defined in widgets/analyser.py
+        self.logic_analyser = LogicAnalyser(self)
+        self.logic_analyser_wrap = QtGui.QDockWidget('Logic Analyser', self)
+        self.logic_analyser_wrap.setWidget(self.logic_analyser)
+        self.logic_analyser_wrap.hide()
+
         # Set central widget and add dock widgets
         self.setCentralWidget(workspace_wrap)
         self.addDockWidget(QtCore.Qt.LeftDockWidgetArea, workspace_change)
         self.addDockWidget(QtCore.Qt.LeftDockWidgetArea, resource_browser_wrap)
+        self.addDockWidget(QtCore.Qt.BottomDockWidgetArea,
+                           self.logic_analyser_wrap)
 
 
 if __name__ == '__main__':
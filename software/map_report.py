@@ -0,0 +1,351 @@
+""" Reports the memory use of a firmware build from the linker output and
+    fails when it no longer fits the RAM budget
+
+    Reads <name>_linkInfo.xml for the memory ranges, output sections and
+    the object file contributions to each, <name>.map for the global symbol
+    addresses, and the compiler's .asm listings (--keep_asm) for a static
+    estimate of the deepest stack use. Sizes are in 16-bit words.
+
+    The engine tick interrupt runs the timed tasks with interrupts enabled,
+    so it nests in itself once per task level, and any other interrupt can
+    land on top of the innermost one. The stack estimate allows for that.
+
+    Run from the build directory as a post-build step:
+        python ../../software/map_report.py PicoCommander.map
+    The exit status is 1 when a budget is exceeded, which fails the build.
+"""
+import argparse, glob, os, re, sys
+import xml.etree.ElementTree as ElementTree
+
+# Data RAM on the F28069, as named in F28069.cmd
+RAM_PREFIX = 'RAM'
+
+# Words pushed by the CPU when it takes an interrupt
+INTERRUPT_CONTEXT = 14
+# Words pushed by LCR for the return address
+CALL_OVERHEAD = 2
+
+FUNCTION_HEADER = re.compile(r'^;\* FNAME: (\S+)\s+FR SIZE:\s*(\d+)')
+DIRECT_CALL = re.compile(r'^\s+(?:LCR|FFC\s+XAR7,|LB)\s+#(\S+)')
+INDIRECT_CALL = re.compile(r'^\s+LCR\s+\*XAR7')
+ADDRESS_TAKEN = re.compile(r'(?:\.field\s+|#)(_\w+)')
+
+
+class CallCycle(Exception):
+    """ A recursive call chain, whose stack depth has no bound """
+    pass
+
+
+def number(text):
+    return int(text, 0)
+
+
+def read_link_info(file_path):
+    """ Reads the memory ranges and output sections from the linker's XML
+        link information
+        Parameters
+            file_path: The path to the _linkInfo.xml file
+
+        Returns
+            areas: A list of dicts with name, page, origin, length and used
+            sections: A list of dicts with name, address, size and
+                components, a list of (file, input section, size)
+    """
+
+    root = ElementTree.parse(file_path).getroot()
+
+    files = {}
+    for node in root.iter('input_file'):
+        name = node.findtext('name')
+        library = node.findtext('kind') == 'archive' and node.findtext('file')
+        files[node.get('id')] = name if not library or library == name \
+            else '%s : %s' % (node.findtext('file'), name)
+
+    components = {}
+    for node in root.iter('object_component'):
+        ref = node.find('input_file_ref')
+        components[node.get('id')] = (
+            files.get(ref.get('idref'), '?') if ref is not None else '?',
+            node.findtext('name'),
+            number(node.findtext('size', '0')))
+
+    sections = []
+    for node in root.iter('logical_group'):
+        if node.find('run_address') is None:
+            continue
+        contents = node.find('contents')
+        sections.append({
+            'name': node.findtext('name'),
+            'address': number(node.findtext('run_address')),
+            'size': number(node.findtext('size', '0')),
+            'components': [components[ref.get('idref')]
+                           for ref in (contents if contents is not None else [])
+                           if ref.get('idref') in components],
+        })
+
+    areas = []
+    for node in root.iter('memory_area'):
+        areas.append({
+            'name': node.findtext('name'),
+            'page': number(node.findtext('page_id', '0')),
+            'origin': number(node.findtext('origin')),
+            'length': number(node.findtext('length')),
+            'used': number(node.findtext('used_space', '0')),
+        })
+
+    return areas, sections
+
+
+def read_map_symbols(file_path):
+    """ Reads the global symbols, sorted by address, from a linker map
+        Returns
+            symbols: A list of (page, address, name)
+    """
+
+    symbols = []
+    with open(file_path) as f:
+        lines = iter(f.readlines())
+    for line in lines:
+        if line.startswith('GLOBAL SYMBOLS: SORTED BY Symbol Address'):
+            break
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 3 and fields[0] in ('0', '1'):
+            symbols.append((int(fields[0]), int(fields[1], 16), fields[2]))
+        elif line.startswith('[') or line.startswith('GLOBAL'):
+            break
+    return symbols
+
+
+def symbol_sizes(symbols, sections, areas):
+    """ Estimates the size of each data symbol in RAM as the distance to the
+        next symbol or to the end of its output section
+        Returns
+            sizes: A list of (size, name, section name)
+    """
+
+    sizes = []
+    data = sorted(s for s in symbols if s[0] == 1)
+    for section in sections:
+        if not in_ram(section['address'], areas, page=1):
+            continue
+        end = section['address'] + section['size']
+        inside = [s for s in data if section['address'] <= s[1] < end]
+        for i, (page, address, name) in enumerate(inside):
+            limit = inside[i + 1][1] if i + 1 < len(inside) else end
+            sizes.append((limit - address, name, section['name']))
+    return sizes
+
+
+def in_ram(address, areas, page=None):
+    for area in areas:
+        if area['name'].startswith(RAM_PREFIX) and \
+           (page is None or area['page'] == page) and \
+           area['origin'] <= address < area['origin'] + area['length']:
+            return True
+    return False
+
+
+def read_call_graph(asm_dir):
+    """ Reads frame sizes and calls from the compiler's .asm listings
+        Returns
+            functions: A dict of name -> dict with frame, calls, indirect
+                and interrupt
+            address_taken: The functions whose address is used as data,
+                which are the possible targets of indirect calls
+    """
+
+    functions = {}
+    references = set()
+    for file_path in glob.glob(os.path.join(asm_dir, '*.asm')):
+        current = None
+        with open(file_path) as f:
+            for line in f:
+                match = FUNCTION_HEADER.match(line)
+                if match:
+                    current = functions.setdefault(match.group(1), {
+                        'frame': int(match.group(2)), 'calls': set(),
+                        'indirect': False, 'interrupt': False})
+                    continue
+                match = DIRECT_CALL.match(line)
+                if match and current is not None:
+                    current['calls'].add(match.group(1))
+                    continue
+                if INDIRECT_CALL.match(line) and current is not None:
+                    current['indirect'] = True
+                elif current is not None and line.split()[:1] == ['IRET']:
+                    current['interrupt'] = True
+                else:
+                    references.update(ADDRESS_TAKEN.findall(line))
+
+    address_taken = {name for name in references if name in functions}
+    return functions, address_taken
+
+
+def stack_depth(name, functions, address_taken, unknown_frame,
+                path=(), memo=None):
+    """ Returns the deepest stack use from entering a function, and the call
+        chain that reaches it. Functions without a listing, such as library
+        code, count as unknown_frame words
+    """
+
+    if memo is None:
+        memo = {}
+    if name in memo:
+        return memo[name]
+    if name in path:
+        raise CallCycle(' -> '.join(path + (name,)))
+
+    function = functions.get(name)
+    if function is None:
+        return unknown_frame, [name + ' (no listing)']
+
+    callees = set(function['calls'])
+    if function['indirect']:
+        callees |= address_taken
+    best = (0, [])
+    for callee in callees:
+        depth, chain = stack_depth(callee, functions, address_taken,
+                                   unknown_frame, path + (name,), memo)
+        if depth + CALL_OVERHEAD > best[0]:
+            best = (depth + CALL_OVERHEAD, chain)
+
+    memo[name] = (function['frame'] + best[0], [name] + best[1])
+    return memo[name]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('map', help='linker map file')
+    parser.add_argument('--link-info', help='XML link information '
+                        '(default: <map>_linkInfo.xml)')
+    parser.add_argument('--asm-dir', help='directory of .asm listings '
+                        '(default: the map file directory)')
+    parser.add_argument('--ram-budget', type=lambda t: int(t, 0),
+                        default=0x7000,
+                        help='words of data RAM the build may use')
+    parser.add_argument('--stack-headroom', type=lambda t: int(t, 0),
+                        default=0x40,
+                        help='words the stack estimate must leave free')
+    parser.add_argument('--tick-isr', default='_cpu_timer',
+                        help='the interrupt that runs the timed tasks and '
+                        'nests in itself')
+    parser.add_argument('--task-levels', type=int, default=4,
+                        help='times the tick interrupt can nest, '
+                        'ENGINE_MAX_TASKS in firmware/engine.h')
+    parser.add_argument('--unknown-frame', type=lambda t: int(t, 0),
+                        default=0x40,
+                        help='words assumed for functions without a listing')
+    parser.add_argument('--top', type=int, default=15,
+                        help='number of symbols and objects to list')
+    args = parser.parse_args()
+
+    base = os.path.splitext(args.map)[0]
+    link_info = args.link_info or base + '_linkInfo.xml'
+    asm_dir = args.asm_dir or os.path.dirname(os.path.abspath(args.map))
+
+    areas, sections = read_link_info(link_info)
+    symbols = read_map_symbols(args.map)
+    errors = []
+
+    print('Memory ranges (words)')
+    print('  %-12s %4s %8s %8s %8s %5s' % ('name', 'page', 'length', 'used',
+                                           'free', 'used'))
+    ram_used = 0
+    for area in areas:
+        if not area['name'].startswith(RAM_PREFIX) and \
+           not re.match(r'FLASH[A-H]$', area['name']):
+            continue
+        if area['name'].startswith(RAM_PREFIX):
+            ram_used += area['used']
+        print('  %-12s %4d %8d %8d %8d %4d%%' % (
+            area['name'], area['page'], area['length'], area['used'],
+            area['length'] - area['used'],
+            100 * area['used'] // area['length']))
+    print('  data RAM used %d of a %d word budget' % (ram_used,
+                                                      args.ram_budget))
+    if ram_used > args.ram_budget:
+        errors.append('RAM use of %d words exceeds the budget of %d'
+                      % (ram_used, args.ram_budget))
+
+    print('')
+    print('Sections in RAM')
+    stack_size = 0
+    for section in sorted(sections, key=lambda s: -s['size']):
+        if not section['size'] or not in_ram(section['address'], areas):
+            continue
+        if section['name'] == '.stack':
+            stack_size = section['size']
+        print('  %-12s 0x%05x %6d' % (section['name'], section['address'],
+                                      section['size']))
+        objects = {}
+        for file_name, input_name, size in section['components']:
+            if not size:
+                continue
+            objects[file_name] = objects.get(file_name, 0) + size
+        for file_name, size in sorted(objects.items(),
+                                      key=lambda o: -o[1])[:args.top]:
+            print('      %6d  %s' % (size, file_name))
+
+    print('')
+    # Statics have no map entry, so they count towards the global before them
+    print('Largest data symbols (words up to the next global symbol)')
+    for size, name, section in sorted(symbol_sizes(symbols, sections, areas),
+                                      reverse=True)[:args.top]:
+        print('  %6d  %-32s %s' % (size, name, section))
+
+    print('')
+    print('Stack')
+    functions, address_taken = read_call_graph(asm_dir)
+    if '_main' not in functions:
+        print('  %d words reserved; no .asm listings in %s, build with '
+              '--keep_asm for an estimate' % (stack_size, asm_dir))
+    else:
+        try:
+            depth, chain = stack_depth('_main', functions, address_taken,
+                                       args.unknown_frame)
+            isr_depth, isr_chain = 0, []
+            for name, function in functions.items():
+                if function['interrupt'] and name != args.tick_isr:
+                    d, c = stack_depth(name, functions, address_taken,
+                                       args.unknown_frame)
+                    if d > isr_depth:
+                        isr_depth, isr_chain = d, c
+            tick_depth, tick_chain = 0, []
+            if args.tick_isr in functions:
+                tick_depth, tick_chain = stack_depth(
+                        args.tick_isr, functions, address_taken,
+                        args.unknown_frame)
+            # The tick interrupt enables interrupts while it runs a timed
+            # task, so a later tick nests in it, once per task level, each
+            # taken as deep as the tick's deepest chain through EngineRun.
+            # The other interrupts do not nest, so one of them lands on top
+            # of the innermost tick, itself on top of the deepest point of
+            # the main loop
+            tick_levels = args.task_levels if tick_chain else 0
+            worst = depth + tick_levels * (tick_depth + INTERRUPT_CONTEXT) + \
+                (isr_depth + INTERRUPT_CONTEXT if isr_chain else 0)
+            print('  main:      %5d  %s' % (depth, ' -> '.join(chain)))
+            if tick_chain:
+                print('  tick:      %5d  x %d  %s'
+                      % (tick_depth + INTERRUPT_CONTEXT, tick_levels,
+                         ' -> '.join(tick_chain)))
+            if isr_chain:
+                print('  interrupt: %5d  %s' % (isr_depth + INTERRUPT_CONTEXT,
+                                                ' -> '.join(isr_chain)))
+            print('  high-water estimate %d of %d words, headroom %d'
+                  % (worst, stack_size, stack_size - worst))
+            if stack_size - worst < args.stack_headroom:
+                errors.append('stack headroom of %d words is below %d'
+                              % (stack_size - worst, args.stack_headroom))
+        except CallCycle as e:
+            errors.append('recursive call chain, stack depth is unbounded: '
+                          + str(e))
+
+    for error in errors:
+        sys.stderr.write('error: %s\n' % error)
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,6 +1,7 @@
 from PyQt4 import QtGui, QtCore
 from widgets.editor import TextEditor, DragDropEditor
 from widgets.entity import tile, arrow
+from utils import fileop
 
 
 def add_tile(workspace):
@@ -14,3 +15,92 @@ def add_tile(workspace):
 
     workspace.currentWidget().numOfChildren += 1
     workspace.update()
+
+
+def edit_task(workspace):
+    """ Sets the period and priority of a timed task, or removes it. Timed
+        tasks pre-empt the background scan, and each other by priority
+        Parameters
+            workspace: The current workspace widget
+
+    """
+    editor = workspace.currentWidget()
+    if type(editor) is not DragDropEditor:
+        return
+
+    items = ["Task " + str(n) for n in range(1, fileop.UPL_MAX_TASKS)]
+    item, ok = QtGui.QInputDialog.getItem(
+            editor, "Edit Task", "Task", items, 0, False)
+    if not ok:
+        return
+    n = items.index(item) + 1
+    period, priority = editor.tasks.get(n, (10, 0))
+
+    period, ok = QtGui.QInputDialog.getInt(
+            editor, "Edit Task", "Period in ms (0 to remove the task)",
+            period, 0, 65535)
+    if not ok:
+        return
+
+    # The tiles of a removed task go back to the background scan
+    if period == 0:
+        editor.tasks.pop(n, None)
+        for t in editor.findChildren(tile):
+            if t.task == n:
+                t.set_task(0)
+    else:
+        priority, ok = QtGui.QInputDialog.getInt(
+                editor, "Edit Task", "Priority, higher pre-empts lower",
+                priority, 0, fileop.UPL_MAX_PRIORITY)
+        if not ok:
+            return
+        editor.tasks[n] = (period, priority)
+
+    workspace.save_state_change(False)
+
+
+def assign_task(workspace):
+    """ Moves a tile, and optionally every tile feeding it, to a task
+        Parameters
+            workspace: The current workspace widget
+
+    """
+    editor = workspace.currentWidget()
+    if type(editor) is not DragDropEditor:
+        return
+
+    tiles = dict((t.ref, t) for t in editor.findChildren(tile))
+    if not tiles:
+        return
+    refs = sorted(tiles)
+    items = [str(ref) + " " + tiles[ref].func_dict.get('FunctionName', '')
+             for ref in refs]
+    item, ok = QtGui.QInputDialog.getItem(
+            editor, "Assign Task", "Tile", items, 0, False)
+    if not ok:
+        return
+    ref = refs[items.index(item)]
+
+    numbers = [0] + sorted(editor.tasks)
+    items = ["Background"] + ["Task %d (%d ms, priority %d)" %
+                              ((n,) + editor.tasks[n]) for n in numbers[1:]]
+    item, ok = QtGui.QInputDialog.getItem(
+            editor, "Assign Task", "Task", items, 0, False)
+    if not ok:
+        return
+    task = numbers[items.index(item)]
+
+    # Walk the arrows back from the tile to take its whole subgraph along
+    moved = [ref]
+    upstream = QtGui.QMessageBox.question(
+            editor, "Assign Task", "Also move the tiles feeding this one?",
+            QtGui.QMessageBox.Yes | QtGui.QMessageBox.No, QtGui.QMessageBox.No)
+    if upstream == QtGui.QMessageBox.Yes:
+        for r in moved:
+            for a in tiles[r].arrows:
+                if a.output == r and a.input in tiles and a.input not in moved:
+                    moved.append(a.input)
+
+    for r in moved:
+        tiles[r].set_task(task)
+    workspace.save_state_change(False)
@@ -1,7 +1,27 @@
 from PyQt4 import QtGui
 from widgets.editor import TextEditor, DragDropEditor
 from widgets.entity import tile, arrow
-import os, datetime, sys
+from utils.opcodes import OPCODES
+import os, datetime, sys, struct
+
+# UPL v2 binary encoding, see firmware/engine.h
+UPL_MAGIC = b'UP'
+UPL_VERSION = 2
+# UPL v3 splits the tiles into tasks, task 0 being the background scan
+UPL_VERSION_TASKS = 3
+UPL_MAX_TASKS = 4
+UPL_MAX_PRIORITY = 255
+# Tiles are numbered 1 to UPL_MAX_TILE (ENGINE_MAX_TILES - 1 in the firmware)
+UPL_MAX_TILE = 511
+
+# The value type each input and output kind carries, see firmware/opcodes.h
+VALUE_TYPES = {'set': 'int', 'set32': 'int32', 'setiq': 'iq', 'setf': 'float'}
+# Fixed point values are Q16
+IQ_ONE = 1 << 16
+
+# Functions from this code up run on the CLA, which only the background task
+# drives, see firmware/opcodes.h
+CLA_BASE = 0xE000
 
 
 def create_blank_file(workspace):
@@ -106,6 +126,10 @@ def save_file(parent, work_path, workspace):
                 save_text += " " + v['LibraryPath']
                 already_saved_libs.append(v['LibraryPath'])
 
+        # Then the timed tasks
+        for n, (period, priority) in sorted(current_tab.tasks.items()):
+            save_text += "\nT " + str(n) + " " + str(period) + " " + str(priority)
+
         # Second, aesthetics
         for v in tiles:
             save_text += "\n#"
@@ -114,6 +138,7 @@ def save_file(parent, work_path, workspace):
             save_text += " " + str(v.y())
             save_text += " " + v.func_dict['FunctionReference']
             save_text += " " + v.set_value
+            save_text += " " + str(v.task)
 
         # Next, save the connections
         for v in arrows:
@@ -175,7 +200,11 @@ def save_as(parent, work_path, workspace):
         tiles = current_tab.findChildren(tile)
         save_text = str(datetime.datetime.now())
 
-        # First, aesthetics
+        # First, the timed tasks
+        for n, (period, priority) in sorted(current_tab.tasks.items()):
+            save_text += "\nT " + str(n) + " " + str(period) + " " + str(priority)
+
+        # Then aesthetics
         for v in tiles:
             save_text += "\n#"
             save_text += " " + str(v.ref)
@@ -183,6 +212,7 @@ def save_as(parent, work_path, workspace):
             save_text += " " + str(v.y())
             save_text += " " + v.func_dict['FunctionReference']
             save_text += " " + v.set_value
+            save_text += " " + str(v.task)
 
         # Next, save the connections
         for v in arrows:
@@ -226,11 +256,16 @@ def compile_program(parent, work_path, workspace):
     arrow_inputs = []
     arrow_outputs = []
     final_outputs = []
+    # Task 0 is the background scan; the rest run every period ms
+    tasks = {0: (0, 0)}
 
-    # Read file and put tiles and arrows in an array
+    # Read file and put tasks, tiles and arrows in an array
     saved_file = open(f.filePath)
     line = saved_file.readline()
     while line[0] != '#':
+        if line[0] == 'T':
+            params = line.split()
+            tasks[int(params[1])] = (int(params[2]), int(params[3]))
         line = saved_file.readline()
     while line[0] != '>':
         line = line.strip("\n")
@@ -250,8 +285,10 @@ def compile_program(parent, work_path, workspace):
         if i not in arrow_inputs and i not in final_outputs:
             final_outputs.append(i)
 
-    # Set the call order of the tiles
-    x = [[final_outputs[0]]]
+    # Set the call order of the tiles, from every final output so that
+    # separate graphs, such as a fast interlock and the slow logic beside
+    # it, are all compiled
+    x = [list(final_outputs)]
     i = 1
     while x[-1] != []:
         sub = []
@@ -264,41 +301,253 @@ def compile_program(parent, work_path, workspace):
     x.pop()
     x.reverse()
 
+    # A tile deeper in one graph than another is called at its deepest
     already_compiled = []
     for comp in x:
         for a in comp:
-            if a in already_compiled:
-                comp.remove(a)
-            else:
+            if a not in already_compiled:
                 already_compiled.append(a)
 
-    # Create a .upl file based on this information
+    # Create a .upl file based on this information, one record per tile:
     # Function reference
-    # Input type (either absolute or relative)
-    # Store the output value in a variable
-    upl_text = ""
-    for v in x:
-        for tile_ref in v:
-            upl_text += tiles[int(tile_ref) - 1][4]
-            if tiles[int(tile_ref) - 1][5] != "None":
-                upl_text += "i" + tiles[int(tile_ref) - 1][5]
-            else:
-                for arrow in arrows:
-                    if arrow[6] == tile_ref:
-                        upl_text += "i" + "o" + arrow[5]
-            upl_text += "o" + tile_ref
-            upl_text += "#"
-    upl_text += "#"
+    # Inputs, either set values or the numbers of the tiles feeding them
+    # The tile's own number, where its output is stored
+    # The records of each task keep the call order, and a tile may read the
+    # outputs of other tasks as of their last run
+    records = dict((n, []) for n in tasks)
+    for tile_ref in already_compiled:
+        tile_line = tiles[int(tile_ref) - 1]
+        if not check_tile(parent, tile_line, arrows, tiles):
+            return
+        if int(tile_ref) > UPL_MAX_TILE:
+            QtGui.QMessageBox.warning(parent, "Compiler",
+                    "The board runs at most " + str(UPL_MAX_TILE) + " tiles")
+            return
+        code = int(tile_line[4], 16)
+        task = int(tile_line[6]) if len(tile_line) > 6 else 0
+        if task not in tasks:
+            QtGui.QMessageBox.warning(parent, "Compiler",
+                    "Tile " + tile_ref + " is in task " + str(task) +
+                    ", which has no period set")
+            return
+        if task and code >= CLA_BASE:
+            QtGui.QMessageBox.warning(parent, "Compiler",
+                    "Tile " + tile_ref + " runs on the CLA, which only the "
+                    "background task can use")
+            return
+        func = OPCODES['0x%04X' % code]
+        if task and func['background']:
+            QtGui.QMessageBox.warning(parent, "Compiler",
+                    "Tile " + tile_ref + " reads the state of the background "
+                    "scan, so only the background task can use it")
+            return
+        inputs = []
+        for n, i in enumerate(tile_inputs(tile_line, arrows)):
+            if i.startswith("io"):
+                inputs.append([int(i[2:])])
+                continue
+            try:
+                inputs.append(set_value_fields(i[1:], input_kind(func, n)))
+            except ValueError:
+                QtGui.QMessageBox.warning(parent, "Compiler",
+                        "Tile " + tile_ref + " has a bad set value " + i[1:])
+                return
+        records[task].append((code, int(tile_ref), inputs))
+
+    # A program all in the background task stays UPL v2
+    timed = [n for n in sorted(tasks) if n and records[n]]
+    if timed:
+        program = encode_upl_tasks(
+                [(tasks[n][0], tasks[n][1], records[n])
+                 for n in sorted(tasks) if records[n]])
+    else:
+        program = encode_upl(records[0])
 
     # Finally, write the file
     name = f.filePath[:-4] + ".upl"
-    out_file = open(name, 'wb')
-    upl_text = bytes(upl_text, 'utf-8')
-    out_file.write(upl_text)
-    out_file.close
+    with open(name, 'wb') as out_file:
+        out_file.write(program)
     QtGui.QMessageBox.warning(parent, "Compiler", "Compilation Successful")
 
 
+def encode_upl(records):
+    """ Encodes a program as UPL v2
+        Parameters
+            records: A list of (function code, tile number, inputs) in call
+                order, each input a list of fields: a tile number, or a set
+                value (two fields, low half first, for 32-bit types)
+
+        Returns
+            The program as bytes, all fields 16-bit little endian
+    """
+
+    program = UPL_MAGIC + struct.pack('<HH', UPL_VERSION, len(records))
+    return program + encode_tiles(records)
+
+
+def encode_upl_tasks(tasks):
+    """ Encodes a program split into tasks as UPL v3
+        Parameters
+            tasks: A list of (period, priority, records), the period in ms
+                or 0 for the background task, and the records as for
+                encode_upl
+
+        Returns
+            The program as bytes, all fields 16-bit little endian
+    """
+
+    program = UPL_MAGIC + struct.pack('<HH', UPL_VERSION_TASKS, len(tasks))
+    for period, priority, records in tasks:
+        program += struct.pack('<HHH', period, priority, len(records))
+        program += encode_tiles(records)
+    return program
+
+
+def encode_tiles(records):
+    """ Encodes the tile records of a UPL v2 program or v3 task """
+
+    program = b''
+    for code, tile_ref, inputs in records:
+        fields = [value & 0xFFFF for field in inputs for value in field]
+        program += struct.pack('<HHH', code, tile_ref, len(inputs))
+        program += struct.pack('<%dH' % len(fields), *fields)
+    return program
+
+
+def value_type(kind):
+    """ The value type carried by an input or output kind """
+
+    return VALUE_TYPES.get(kind, kind)
+
+
+def input_kind(func, n):
+    """ The kind of a function's nth input; variadic extras repeat the last """
+
+    return func['inputs'][min(n, len(func['inputs']) - 1)][1]
+
+
+def set_value_fields(text, kind):
+    """ Converts a set value as typed in the editor to its UPL fields
+        Parameters
+            text: The value, hex for set and set32, decimal for setiq and setf
+            kind: The kind of the input it is set on
+
+        Returns
+            A list of one 16-bit field, or two (low half first) for 32-bit
+            types. Raises ValueError if the text is not a number
+    """
+
+    if kind == 'set32':
+        value = int(text, 16)
+    elif kind == 'setiq':
+        value = int(round(float(text) * IQ_ONE))
+    elif kind == 'setf':
+        value = struct.unpack('<I', struct.pack('<f', float(text)))[0]
+    else:
+        return [int(text, 16)]
+    return [value & 0xFFFF, (value >> 16) & 0xFFFF]
+
+
+def check_tile(parent, tile_line, arrows, tiles):
+    """ Checks a tile against the firmware's opcode table (utils/opcodes.py,
+        generated by gen_opcodes.py) before it is compiled
+        Parameters
+            parent: The widget to show warnings on
+            tile_line: The tile's line from the saved file, split on spaces
+            arrows: The saved arrows, split on spaces
+            tiles: Every saved tile line, to check the types of connections
+
+        Returns
+            True if the firmware can run the tile
+    """
+
+    try:
+        func = OPCODES['0x%04X' % int(tile_line[4], 16)]
+    except (KeyError, ValueError):
+        QtGui.QMessageBox.warning(parent, "Compiler",
+                "Tile " + tile_line[1] + " uses a function the board does not support")
+        return False
+
+    inputs = tile_inputs(tile_line, arrows)
+    num_of_inputs = len(inputs)
+
+    # Variadic functions take at least as many inputs as they declare
+    if ((func['variadic'] and num_of_inputs < len(func['inputs'])) or
+            (not func['variadic'] and num_of_inputs != len(func['inputs']))):
+        QtGui.QMessageBox.warning(parent, "Compiler",
+                "Tile " + tile_line[1] + " (" + func['name'] + ") needs " +
+                str(len(func['inputs'])) + " input(s) but has " +
+                str(num_of_inputs))
+        return False
+
+    # Values are not converted on the board, so each connection must carry
+    # the type its input expects
+    for n, i in enumerate(inputs):
+        if not i.startswith("io"):
+            continue
+        expected = value_type(input_kind(func, n))
+        try:
+            source = OPCODES['0x%04X' % int(tiles[int(i[2:]) - 1][4], 16)]
+            given = value_type(source['outputs'][0][1])
+        except (KeyError, ValueError, IndexError):
+            continue
+        if given != expected:
+            QtGui.QMessageBox.warning(parent, "Compiler",
+                    "Tile " + tile_line[1] + " (" + func['name'] + ") input " +
+                    str(n + 1) + " takes " + expected + " but tile " + i[2:] +
+                    " (" + source['name'] + ") gives " + given)
+            return False
+
+    return True
+
+
+def tile_inputs(tile_line, arrows):
+    """ Lists a tile's UPL inputs in the order its library function
+        declares them, so set values and connections can be mixed
+        Parameters
+            tile_line: The tile's line from the saved file, split on spaces
+            arrows: The saved arrows, split on spaces
+
+        Returns
+            inputs: A list of "i<set value>" and "io<n>" strings
+    """
+
+    func = OPCODES['0x%04X' % int(tile_line[4], 16)]
+    names = [name for name, kind in func['inputs']]
+
+    # Connections made to a named input go there, the rest fill in order
+    named = {}
+    unnamed = []
+    for a in arrows:
+        if a[6] != tile_line[1]:
+            continue
+        sel_in = a[7].strip() if len(a) > 7 else "None"
+        if sel_in in names and sel_in not in named:
+            named[sel_in] = a[5]
+        else:
+            unnamed.append(a[5])
+
+    # Set values are comma separated in the order of the set inputs. Older
+    # files have a single value shared by all of them
+    set_values = tile_line[5].split(',') if tile_line[5] != "None" else []
+
+    inputs = []
+    for name, kind in func['inputs']:
+        if kind.startswith('set'):
+            if set_values:
+                inputs.append("i" + (set_values.pop(0) if len(set_values) > 1
+                                     else set_values[0]))
+        elif name in named:
+            inputs.append("io" + named.pop(name))
+        elif unnamed:
+            inputs.append("io" + unnamed.pop(0))
+
+    # Variadic functions take every remaining connection
+    inputs += ["io" + ref for ref in list(named.values()) + unnamed]
+
+    return inputs
+
+
 def tile_dependancies(ref, arrows):
     dependants = []
 
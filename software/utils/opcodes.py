@@ -0,0 +1,461 @@
+# Automatically generated by gen_opcodes.py from the libraries in
+# lib/.  Do not edit!
+
+OPCODES = {
+    '0x2000': {
+        'name': 'ReadInput',
+        'inputs': [],
+        'variadic': False,
+        'outputs': [('outputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x2001': {
+        'name': 'CapturedRising',
+        'inputs': [],
+        'variadic': False,
+        'outputs': [('risen', 'int')],
+        'states': [],
+        'background': True,
+    },
+    '0x2002': {
+        'name': 'CapturedFalling',
+        'inputs': [],
+        'variadic': False,
+        'outputs': [('fallen', 'int')],
+        'states': [],
+        'background': True,
+    },
+    '0x2003': {
+        'name': 'AnalogInput',
+        'inputs': [('channel', 'set')],
+        'variadic': False,
+        'outputs': [('value', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x2004': {
+        'name': 'InputFrequency',
+        'inputs': [],
+        'variadic': False,
+        'outputs': [('frequency', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0x2005': {
+        'name': 'EncoderCount',
+        'inputs': [('mode', 'set'), ('reset', 'int')],
+        'variadic': False,
+        'outputs': [('count', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0x2006': {
+        'name': 'ExpansionInput',
+        'inputs': [('board', 'set')],
+        'variadic': False,
+        'outputs': [('inputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x4000': {
+        'name': 'SetOutput',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('outputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x4001': {
+        'name': 'PWMOutput',
+        'inputs': [('channel', 'set'), ('frequency', 'float'), ('duty', 'float')],
+        'variadic': False,
+        'outputs': [('duty', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0x4002': {
+        'name': 'ExpansionOutput',
+        'inputs': [('board', 'set'), ('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('outputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8001': {
+        'name': 'OctalShiftLeft',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('outputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8002': {
+        'name': 'OctalShiftRight',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('outputBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8003': {
+        'name': 'OctalAND',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AandB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8004': {
+        'name': 'MultiAND',
+        'inputs': [('inputs', 'int')],
+        'variadic': True,
+        'outputs': [('allAND', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8005': {
+        'name': 'MultiOR',
+        'inputs': [('inputs', 'int')],
+        'variadic': True,
+        'outputs': [('allOR', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8006': {
+        'name': 'MultiXOR',
+        'inputs': [('inputs', 'int')],
+        'variadic': True,
+        'outputs': [('allXOR', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8007': {
+        'name': 'MultiADD',
+        'inputs': [('inputs', 'int')],
+        'variadic': True,
+        'outputs': [('sum', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8008': {
+        'name': 'OctalOR',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AorB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x8009': {
+        'name': 'OctalXOR',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AxorB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x800A': {
+        'name': 'OctalNOT',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('notBits', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0x800B': {
+        'name': 'RisingEdge',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('risen', 'int')],
+        'states': [('previous', 'int')],
+        'background': False,
+    },
+    '0x800C': {
+        'name': 'FallingEdge',
+        'inputs': [('inputBits', 'int')],
+        'variadic': False,
+        'outputs': [('fallen', 'int')],
+        'states': [('previous', 'int')],
+        'background': False,
+    },
+    '0xA001': {
+        'name': 'HexConstant',
+        'inputs': [('value', 'set')],
+        'variadic': False,
+        'outputs': [('hexConstant', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xA002': {
+        'name': 'OnDelay',
+        'inputs': [('enable', 'int'), ('preset', 'set')],
+        'variadic': False,
+        'outputs': [('done', 'int')],
+        'states': [('elapsed', 'int')],
+        'background': False,
+    },
+    '0xA003': {
+        'name': 'OffDelay',
+        'inputs': [('enable', 'int'), ('preset', 'set')],
+        'variadic': False,
+        'outputs': [('active', 'int')],
+        'states': [('elapsed', 'int')],
+        'background': False,
+    },
+    '0xA004': {
+        'name': 'Counter',
+        'inputs': [('count', 'int'), ('reset', 'int')],
+        'variadic': False,
+        'outputs': [('total', 'int')],
+        'states': [('previous', 'int'), ('total', 'int')],
+        'background': False,
+    },
+    '0xC001': {
+        'name': 'Add',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('sum', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC002': {
+        'name': 'Subtract',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('difference', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC003': {
+        'name': 'GreaterThan',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AgtB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC004': {
+        'name': 'LessThan',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AltB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC005': {
+        'name': 'Equal',
+        'inputs': [('inputA', 'int'), ('inputB', 'int')],
+        'variadic': False,
+        'outputs': [('AeqB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC101': {
+        'name': 'Constant32',
+        'inputs': [('value', 'set32')],
+        'variadic': False,
+        'outputs': [('constant', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0xC102': {
+        'name': 'Add32',
+        'inputs': [('inputA', 'int32'), ('inputB', 'int32')],
+        'variadic': False,
+        'outputs': [('sum', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0xC103': {
+        'name': 'Subtract32',
+        'inputs': [('inputA', 'int32'), ('inputB', 'int32')],
+        'variadic': False,
+        'outputs': [('difference', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0xC104': {
+        'name': 'Multiply32',
+        'inputs': [('inputA', 'int32'), ('inputB', 'int32')],
+        'variadic': False,
+        'outputs': [('product', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0xC201': {
+        'name': 'ConstantIQ',
+        'inputs': [('value', 'setiq')],
+        'variadic': False,
+        'outputs': [('constant', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC202': {
+        'name': 'AddIQ',
+        'inputs': [('inputA', 'iq'), ('inputB', 'iq')],
+        'variadic': False,
+        'outputs': [('sum', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC203': {
+        'name': 'SubtractIQ',
+        'inputs': [('inputA', 'iq'), ('inputB', 'iq')],
+        'variadic': False,
+        'outputs': [('difference', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC204': {
+        'name': 'MultiplyIQ',
+        'inputs': [('inputA', 'iq'), ('inputB', 'iq')],
+        'variadic': False,
+        'outputs': [('product', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC301': {
+        'name': 'ConstantF',
+        'inputs': [('value', 'setf')],
+        'variadic': False,
+        'outputs': [('constant', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC302': {
+        'name': 'AddF',
+        'inputs': [('inputA', 'float'), ('inputB', 'float')],
+        'variadic': False,
+        'outputs': [('sum', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC303': {
+        'name': 'SubtractF',
+        'inputs': [('inputA', 'float'), ('inputB', 'float')],
+        'variadic': False,
+        'outputs': [('difference', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC304': {
+        'name': 'MultiplyF',
+        'inputs': [('inputA', 'float'), ('inputB', 'float')],
+        'variadic': False,
+        'outputs': [('product', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC305': {
+        'name': 'DivideF',
+        'inputs': [('inputA', 'float'), ('inputB', 'float')],
+        'variadic': False,
+        'outputs': [('quotient', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC306': {
+        'name': 'GreaterThanF',
+        'inputs': [('inputA', 'float'), ('inputB', 'float')],
+        'variadic': False,
+        'outputs': [('AgtB', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC401': {
+        'name': 'IntToInt32',
+        'inputs': [('value', 'int')],
+        'variadic': False,
+        'outputs': [('result', 'int32')],
+        'states': [],
+        'background': False,
+    },
+    '0xC402': {
+        'name': 'Int32ToInt',
+        'inputs': [('value', 'int32')],
+        'variadic': False,
+        'outputs': [('result', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC403': {
+        'name': 'IntToIQ',
+        'inputs': [('value', 'int')],
+        'variadic': False,
+        'outputs': [('result', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC404': {
+        'name': 'IQToInt',
+        'inputs': [('value', 'iq')],
+        'variadic': False,
+        'outputs': [('result', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC405': {
+        'name': 'IntToFloat',
+        'inputs': [('value', 'int')],
+        'variadic': False,
+        'outputs': [('result', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC406': {
+        'name': 'FloatToInt',
+        'inputs': [('value', 'float')],
+        'variadic': False,
+        'outputs': [('result', 'int')],
+        'states': [],
+        'background': False,
+    },
+    '0xC407': {
+        'name': 'IQToFloat',
+        'inputs': [('value', 'iq')],
+        'variadic': False,
+        'outputs': [('result', 'float')],
+        'states': [],
+        'background': False,
+    },
+    '0xC408': {
+        'name': 'FloatToIQ',
+        'inputs': [('value', 'float')],
+        'variadic': False,
+        'outputs': [('result', 'iq')],
+        'states': [],
+        'background': False,
+    },
+    '0xC501': {
+        'name': 'PID',
+        'inputs': [('setpoint', 'float'), ('measurement', 'float'), ('kp', 'setf'), ('ki', 'setf'), ('kd', 'setf'), ('outMin', 'setf'), ('outMax', 'setf'), ('period', 'set')],
+        'variadic': False,
+        'outputs': [('output', 'float')],
+        'states': [('integral', 'float'), ('previous', 'float'), ('output', 'float'), ('elapsed', 'int'), ('started', 'int')],
+        'background': False,
+    },
+    '0xE001': {
+        'name': 'MovingAverage',
+        'inputs': [('value', 'int'), ('length', 'set')],
+        'variadic': False,
+        'outputs': [('average', 'int')],
+        'states': [('job', 'int')],
+        'background': False,
+    },
+    '0xE002': {
+        'name': 'FIRFilter',
+        'inputs': [('value', 'int'), ('tap0', 'set'), ('tap1', 'set'), ('tap2', 'set'), ('tap3', 'set')],
+        'variadic': False,
+        'outputs': [('filtered', 'int')],
+        'states': [('job', 'int')],
+        'background': False,
+    },
+    '0xE003': {
+        'name': 'Scale',
+        'inputs': [('value', 'int'), ('numerator', 'set'), ('denominator', 'set'), ('offset', 'set')],
+        'variadic': False,
+        'outputs': [('scaled', 'int')],
+        'states': [('job', 'int')],
+        'background': False,
+    },
+}
@@ -1,31 +1,411 @@
 from PyQt4 import QtGui
 import serial
 import serial.tools.list_ports
+import struct
+import threading
+import time
+from concurrent.futures import Future
 
 BAUD_RATE = 9600
 TIMEOUT = 0.5
+# The board is silent while it erases and programs the flash sector that
+# stores the program, which takes about 2 s
+SAVE_TIMEOUT = 5.0
 CONNECTION_INFO = []
 
+# Binary command protocol, see firmware/protocol.h
+SYNC = 0xA5
+MAX_PAYLOAD = 59
+CMD_PING = 0x00
+CMD_UPLOAD = 0x01
+CMD_RUN = 0x02
+CMD_STOP = 0x03
+CMD_STEP = 0x04
+CMD_READ_VALUE = 0x05
+CMD_WRITE_VALUE = 0x06
+CMD_STATS = 0x07
+CMD_STREAM = 0x08
+CMD_MEMORY = 0x09
+CMD_FAULT = 0x0A
+CMD_SAFE_STATE = 0x0B
+CMD_CAPTURE = 0x0C
+CMD_PATTERN_LOAD = 0x0D
+CMD_PATTERN_QUEUE = 0x0E
+CMD_PATTERN_PLAY = 0x0F
 
-def detect_and_connect(master_app):
+# Program store state in the stats, see firmware/protocol.h
+STORE_PENDING = 0x00
+STORE_SAVED = 0x01
+STORE_FAILED = 0x02
+RESPONSE = 0x80
 
-    CONNECTION_INFO = []
-    available_ports = list(serial.tools.list_ports.comports())
-    for port in available_ports:
-        if "USB Serial Device" in port[1]:
-            CONNECTION_INFO = port
-    if CONNECTION_INFO == []:
-        QtGui.QMessageBox.warning(master_app, "Connection", "Could not connect! Please connect a board and try again")
+STATUS_OK = 0x00
+STATUS_TEXT = {
+    0x01: "unknown command",
+    0x02: "bad length",
+    0x03: "bad argument",
+    0x04: "program rejected",
+}
 
-    ser = serial.Serial()
-    ser.baudrate = BAUD_RATE
-    ser.port = CONNECTION_INFO[0]
-    ser.timeout = TIMEOUT
-    ser.open()
-    QtGui.QMessageBox.information(master_app, "Connection", "Connection successful!")
-    ser.close()
+# Fixed point values are Q16, see OPCODE_IQ_Q in firmware/opcodes.h
+IQ_ONE = 1 << 16
 
-def upload(master_app):
+# Logic analyser capture, see firmware/logic.h
+CAPTURE_MAX_HZ = 200000
+CAPTURE_FLAG_LOST = 0x01
+
+# Pattern playback, see firmware/pattern.h
+PATTERN_MIN_HZ = 10
+PATTERN_MAX_HZ = 100000
+PATTERN_BANK_SIZE = 1024
+PATTERN_FLAG_LOOP = 0x01
+PATTERN_STATE_PLAYING = 0x01
+PATTERN_STATE_QUEUED = 0x02
+
+# Supervisor fault flags, see firmware/supervisor.h
+FAULT_OVERRUN = 0x0001
+FAULT_WATCHDOG = 0x0002
+
+
+def decode_value(raw, kind='int'):
+    """ Converts the 32 bits of a value slot to a number by its tile type """
+
+    if kind in ('float', 'setf'):
+        return struct.unpack('<f', struct.pack('<i', raw))[0]
+    if kind in ('iq', 'setiq'):
+        return raw / IQ_ONE
+    if kind in ('int', 'set'):
+        return struct.unpack('<h', struct.pack('<i', raw)[:2])[0]
+    return raw
+
+
+def encode_value(value, kind='int'):
+    """ Converts a number to the 32 bits of a value slot by its tile type """
+
+    if kind in ('float', 'setf'):
+        return struct.unpack('<i', struct.pack('<f', value))[0]
+    if kind in ('iq', 'setiq'):
+        return int(round(value * IQ_ONE))
+    return int(value)
+
+
+def decode_capture(payload):
+    """ Splits a capture frame into its lost flag and its runs
+        Returns
+            lost: True if samples were dropped just before this frame
+            runs: A list of (inputs, count), inputs one bit per ReadInput
+                bit and count the number of samples they held for
+    """
+
+    runs = [(payload[i], payload[i + 1] + 1)
+            for i in range(1, len(payload) - 1, 2)]
+    return bool(payload[0] & CAPTURE_FLAG_LOST), runs
+
+
+class BoardError(Exception):
+    """ A command the board answered with an error status """
+    pass
+
+
+class BoardClient():
+    """ Talks to the board with the binary command protocol
+
+        Every request returns a concurrent.futures.Future straight away and
+        is matched to its response by message ID, so several requests can
+        be in flight at once. Use future.result() to wait, or
+        asyncio.wrap_future() from a coroutine.
+    """
+
+    def __init__(self, port):
+        self.ser = serial.Serial()
+        self.ser.baudrate = BAUD_RATE
+        self.ser.port = port
+        self.ser.timeout = 0.05
+        self.ser.open()
+
+        self.lock = threading.Lock()
+        self.pending = {}
+        self.next_id = 1
+        self.stream_callback = None
+        self.fault_callback = None
+        self.capture_callback = None
+        self.pattern_callback = None
+
+        self.running = True
+        self.reader = threading.Thread(target=self._read_loop, daemon=True)
+        self.reader.start()
+
+    def close(self):
+        self.running = False
+        self.reader.join()
+        self.ser.close()
+        with self.lock:
+            for future in self.pending.values():
+                future.set_exception(BoardError("connection closed"))
+            self.pending = {}
+
+    def request(self, command, payload=b''):
+        """ Sends a command and returns a Future for its response payload """
+
+        future = Future()
+        with self.lock:
+            # IDs 1-255 are used for requests, 0 marks streamed values
+            msg_id = self.next_id
+            self.next_id = self.next_id % 255 + 1
+            self.pending[msg_id] = future
+
+            body = bytes([msg_id, command, len(payload)]) + payload
+            self.ser.write(bytes([SYNC]) + body + bytes([sum(body) & 0xFF]))
+        return future
+
+    def _read_loop(self):
+        buf = b''
+        while self.running:
+            buf += self.ser.read(64)
+            while True:
+                start = buf.find(bytes([SYNC]))
+                if start < 0:
+                    buf = b''
+                    break
+                buf = buf[start:]
+                if len(buf) >= 4 and buf[3] > MAX_PAYLOAD:
+                    buf = buf[1:]
+                    continue
+                if len(buf) < 4 or len(buf) < 5 + buf[3]:
+                    break
+                length = buf[3]
+                body = buf[1:4 + length]
+                check = buf[4 + length]
+                if sum(body) & 0xFF != check:
+                    buf = buf[1:]
+                    continue
+                buf = buf[5 + length:]
+                self._dispatch(body[0], body[1], body[3:])
+
+    def _dispatch(self, msg_id, command, payload):
+        if msg_id == 0:
+            if command == CMD_STREAM | RESPONSE and \
+               self.stream_callback is not None:
+                count = len(payload) // 4
+                self.stream_callback(struct.unpack('<%di' % count, payload))
+            elif command == CMD_FAULT | RESPONSE and \
+                    self.fault_callback is not None:
+                self.fault_callback(self._fault(payload[1:]))
+            elif command == CMD_CAPTURE | RESPONSE and \
+                    self.capture_callback is not None:
+                self.capture_callback(*decode_capture(payload))
+            elif command == CMD_PATTERN_QUEUE | RESPONSE and \
+                    self.pattern_callback is not None:
+                self.pattern_callback(payload[1])
+            return
+
+        with self.lock:
+            future = self.pending.pop(msg_id, None)
+        if future is None:
+            return
+        if payload[0] != STATUS_OK:
+            future.set_exception(BoardError(
+                STATUS_TEXT.get(payload[0], "status %d" % payload[0])))
+        else:
+            future.set_result(payload[1:])
+
+    def _then(self, future, convert):
+        """ Returns a Future for convert(result) of another Future """
+
+        converted = Future()
+
+        def done(f):
+            if f.exception() is not None:
+                converted.set_exception(f.exception())
+            else:
+                converted.set_result(convert(f.result()))
+        future.add_done_callback(done)
+        return converted
+
+    def ping(self):
+        return self.request(CMD_PING)
+
+    def upload(self, program):
+        """ Sends a UPL program, v2 binary or v1 text, in chunks and returns the last chunk's
+            Future. Chunks are pipelined; an error in any of them fails
+            the following ones since the board checks offsets
+        """
+
+        chunk_size = MAX_PAYLOAD - 2
+        future = None
+        for offset in range(0, len(program), chunk_size):
+            chunk = program[offset:offset + chunk_size]
+            future = self.request(CMD_UPLOAD, struct.pack('<H', offset) + chunk)
+        return future
+
+    def run(self):
+        """ Compiles the uploaded program and runs it. The board answers
+            first and then saves a new program to flash, with interrupts off
+            for the erase and program, so it does not answer anything else
+            for a few seconds after a new upload
+        """
+
+        return self.request(CMD_RUN)
+
+    def stop(self):
+        return self.request(CMD_STOP)
+
+    def step(self):
+        return self.request(CMD_STEP)
+
+    def read_value(self, slot, kind='int'):
+        """ Returns a Future for the value of a slot, converted by the type
+            of the tile output it holds
+        """
+
+        return self._then(self.request(CMD_READ_VALUE, struct.pack('<H', slot)),
+                          lambda r: decode_value(struct.unpack('<i', r)[0],
+                                                 kind))
+
+    def write_value(self, slot, value, kind='int'):
+        return self.request(CMD_WRITE_VALUE,
+                            struct.pack('<Hi', slot,
+                                        encode_value(value, kind)))
+
+    def stats(self):
+        def convert(r):
+            fields = struct.unpack('<IIIIHHBBB', r)
+            return dict(zip(('scans', 'scan_cycles', 'max_scan_cycles',
+                             'max_usb_int_cycles', 'capture_overflows',
+                             'program_length', 'compiled', 'running',
+                             'stored'),
+                            fields))
+        return self._then(self.request(CMD_STATS), convert)
+
+    def wait_saved(self):
+        """ Waits for the board to save the program run() compiled to
+            flash, and returns True if it will run again after a reset
+        """
+
+        deadline = time.time() + SAVE_TIMEOUT
+        while True:
+            stored = self.stats().result(SAVE_TIMEOUT)['stored']
+            if stored != STORE_PENDING or time.time() > deadline:
+                return stored == STORE_SAVED
+
+    def memory(self):
+        """ Returns a Future for a dict of (used, capacity) pairs: stack
+            words at their deepest since boot, program store words, program
+            buffer characters and the engine tables
+        """
+
+        def convert(r):
+            fields = struct.unpack('<HHIIHHHHHHHHHH', r)
+            names = ('stack', 'store', 'program', 'instructions', 'operands',
+                     'constants', 'states')
+            return {name: (fields[2 * i], fields[2 * i + 1])
+                    for i, name in enumerate(names)}
+        return self._then(self.request(CMD_MEMORY), convert)
+
+    def _fault(self, r):
+        return dict(zip(('faults', 'overruns', 'safe_state'),
+                        struct.unpack('<HHB', r)))
+
+    def fault(self):
+        """ Returns a Future for the supervisor's fault flags, overrun
+            count and safe output state. Set fault_callback to be told of
+            faults as they happen; run() clears them
+        """
+
+        return self._then(self.request(CMD_FAULT), self._fault)
+
+    def set_safe_state(self, outputs):
+        """ Sets the outputs, one bit each, driven while no program is in
+            control or after a fault
+        """
+
+        return self.request(CMD_SAFE_STATE, bytes([outputs & 0xFF]))
+
+    def capture(self, rate, callback=None):
+        """ Samples the eight inputs rate times a second and passes them to
+            callback(lost, runs) as they arrive; see decode_capture(). A
+            rate of 0 stops the capture
+        """
+
+        if rate:
+            self.capture_callback = callback
+        return self.request(CMD_CAPTURE, struct.pack('<I', rate))
+
+    def pattern_load(self, words):
+        """ Loads up to PATTERN_BANK_SIZE output words, bit n driving output
+            n, into the pattern buffer that is not playing, and queues them
+            to play next. Returns the Future of the queue request, for the
+            PATTERN_STATE flags. Chunks are pipelined
+        """
+
+        chunk_size = MAX_PAYLOAD - 2
+        for offset in range(0, len(words), chunk_size):
+            chunk = bytes(word & 0xFF for word in
+                          words[offset:offset + chunk_size])
+            self.request(CMD_PATTERN_LOAD,
+                         struct.pack('<H', offset) + chunk)
+        return self._then(self.request(CMD_PATTERN_QUEUE,
+                                       struct.pack('<H', len(words))),
+                          lambda r: r[0])
+
+    def pattern_play(self, rate, outputs, loop=False, callback=None):
+        """ Plays the queued pattern words rate times a second on the
+            outputs set in outputs, one bit each. The board calls
+            callback(state) with the PATTERN_STATE flags each time it moves
+            on to a newly queued buffer, so the other can be loaded, and
+            when it stops at the end. A rate of 0 stops the playback
+        """
+
+        if rate:
+            self.pattern_callback = callback
+        flags = PATTERN_FLAG_LOOP if loop else 0
+        return self._then(self.request(CMD_PATTERN_PLAY,
+                                       struct.pack('<IBB', rate,
+                                                   outputs & 0xFF, flags)),
+                          lambda r: r[0])
+
+    def play_pattern(self, words, rate, outputs, callback=None):
+        """ Streams a pattern of any length, PATTERN_BANK_SIZE words at a
+            time. The second buffer is loaded as soon as the first starts
+            and each later one as the board frees a buffer, so playback
+            continues without a gap while the host keeps up. callback(state)
+            is called once the board stops
+        """
+
+        banks = [words[i:i + PATTERN_BANK_SIZE]
+                 for i in range(0, len(words), PATTERN_BANK_SIZE)]
+        if not banks:
+            raise ValueError("no pattern words")
+        pending = iter(banks[1:])
+
+        def next_bank(state):
+            # Runs on the reader thread, so the requests are not waited on
+            if not state & PATTERN_STATE_PLAYING:
+                if callback is not None:
+                    callback(state)
+                return
+            bank = next(pending, None)
+            if bank is not None:
+                self.pattern_load(bank)
+
+        self.pattern_load(banks[0]).result(TIMEOUT)
+        future = self.pattern_play(rate, outputs, callback=next_bank)
+        future.result(TIMEOUT)
+        next_bank(PATTERN_STATE_PLAYING)
+        return future
+
+    def stream(self, period_ms, slots, callback=None):
+        """ Streams the values of slots every period_ms to callback(values).
+            The values are raw 32 bit slots; see decode_value(). A period
+            of 0 stops streaming
+        """
+
+        self.stream_callback = callback
+        return self.request(CMD_STREAM, struct.pack('<H%dH' % len(slots),
+                                                    period_ms, *slots))
+
+
+def find_port(master_app):
 
     CONNECTION_INFO = []
     available_ports = list(serial.tools.list_ports.comports())
@@ -34,19 +414,44 @@ def upload(master_app):
             CONNECTION_INFO = port
     if CONNECTION_INFO == []:
         QtGui.QMessageBox.warning(master_app, "Connection", "Could not connect! Please connect a board and try again")
+        return None
+    return CONNECTION_INFO[0]
 
-    upl_file_path = QtGui.QFileDialog.getOpenFileName(master_app.workspace, "File to Upload", master_app.work_path, "Upload (*.upl)")
-    upl_file = open(upl_file_path, 'rb')
 
-    ser = serial.Serial()
-    ser.baudrate = BAUD_RATE
-    ser.port = CONNECTION_INFO[0]
-    ser.timeout = TIMEOUT
-    ser.open()
-    ser.write(upl_file.readline())
+def detect_and_connect(master_app):
+
+    port = find_port(master_app)
+    if port is None:
+        return
 
-    response = ser.read(10).decode()
-    if response == "conf":
-        QtGui.QMessageBox.information(master_app, "Connection", "Upload Successful! Program will begin execution")
+    board = BoardClient(port)
+    try:
+        board.ping().result(TIMEOUT)
+        QtGui.QMessageBox.information(master_app, "Connection", "Connection successful!")
+    except Exception:
+        QtGui.QMessageBox.warning(master_app, "Connection", "The board did not answer")
+    board.close()
+
+def upload(master_app):
+
+    port = find_port(master_app)
+    if port is None:
+        return
+
+    upl_file_path = QtGui.QFileDialog.getOpenFileName(master_app.workspace, "File to Upload", master_app.work_path, "Upload (*.upl)")
+    if upl_file_path == "":
+        return
+    with open(upl_file_path, 'rb') as upl_file:
+        program = upl_file.read()
 
-    ser.close()
+    board = BoardClient(port)
+    try:
+        board.upload(program).result(TIMEOUT)
+        board.run().result(TIMEOUT)
+        if board.wait_saved():
+            QtGui.QMessageBox.information(master_app, "Connection", "Upload Successful! Program will begin execution")
+        else:
+            QtGui.QMessageBox.warning(master_app, "Connection", "The program is running but could not be saved to flash, so it will not run after a reset")
+    except Exception as e:
+        QtGui.QMessageBox.warning(master_app, "Connection", "Upload failed: " + str(e))
+    board.close()
@@ -0,0 +1,152 @@
+from PyQt4 import QtGui, QtCore
+from collections import deque
+from utils import ser_con
+
+# The input pins by ReadInput bit, see firmware/logic.c
+INPUT_PINS = ['GPIO12', 'GPIO18', 'GPIO22', 'GPIO33',
+              'GPIO32', 'GPIO0', 'GPIO19', 'GPIO1']
+
+# Sample rates offered, in Hz
+RATES = [1000, 10000, 50000, 100000, ser_con.CAPTURE_MAX_HZ]
+
+# The most runs kept for display, oldest dropped first
+MAX_RUNS = 1000000
+
+
+class LogicTrace(QtGui.QWidget):
+    """ Draws the captured inputs as eight traces, newest on the right """
+
+    LABEL_WIDTH = 60
+
+    def __init__(self):
+        super(LogicTrace, self).__init__()
+
+        # Runs of (inputs, count), with (None, 0) where samples were lost
+        self.runs = deque(maxlen=MAX_RUNS)
+        self.rate = RATES[0]
+        self.span = 1.0
+        self.setMinimumHeight(8 * 30)
+
+    def clear(self, rate):
+        self.runs.clear()
+        self.rate = rate
+        self.update()
+
+    def add_runs(self, lost, runs):
+        """ Appends runs from a capture frame """
+
+        if lost:
+            self.runs.append((None, 0))
+        self.runs.extend(runs)
+        self.update()
+
+    def paintEvent(self, e):
+        painter = QtGui.QPainter(self)
+        painter.fillRect(self.rect(), QtCore.Qt.black)
+
+        row = self.height() / 8.0
+        width = self.width() - self.LABEL_WIDTH
+        per_sample = width / (self.span * self.rate)
+
+        painter.setPen(QtCore.Qt.lightGray)
+        for bit in range(8):
+            painter.drawText(4, int(row * (7 - bit) + row / 2 + 4),
+                             INPUT_PINS[bit])
+
+        # Walk back from the newest run until the window is full
+        x = float(self.width())
+        last = [None] * 8
+        for inputs, count in reversed(self.runs):
+            if inputs is None:
+                painter.setPen(QtCore.Qt.red)
+                painter.drawLine(int(x), 0, int(x), self.height())
+                continue
+            left = max(x - count * per_sample, self.LABEL_WIDTH)
+            painter.setPen(QtCore.Qt.green)
+            for bit in range(8):
+                top = row * (7 - bit) + row * 0.2
+                y = top if inputs & (1 << bit) else top + row * 0.6
+                painter.drawLine(int(left), int(y), int(x), int(y))
+                if last[bit] is not None and last[bit] != y:
+                    painter.drawLine(int(x), int(y), int(x), int(last[bit]))
+                last[bit] = y
+            x = left
+            if x <= self.LABEL_WIDTH:
+                break
+
+
+class LogicAnalyser(QtGui.QWidget):
+    """ Captures the board's eight inputs and shows them as traces """
+
+    # Capture frames arrive on the serial reader thread
+    capturedRuns = QtCore.pyqtSignal(bool, list)
+
+    def __init__(self, master_app):
+        super(LogicAnalyser, self).__init__()
+
+        self.master_app = master_app
+        self.board = None
+
+        self.rate = QtGui.QComboBox(self)
+        self.rate.addItems(['%d Hz' % rate for rate in RATES])
+
+        self.span = QtGui.QComboBox(self)
+        self.spans = [0.001, 0.01, 0.1, 1.0, 10.0]
+        self.span.addItems(['%g s' % span for span in self.spans])
+        self.span.setCurrentIndex(3)
+        self.span.currentIndexChanged.connect(self.change_span)
+
+        self.start_stop = QtGui.QPushButton("Start", self)
+        self.start_stop.clicked.connect(self.toggle)
+
+        self.trace = LogicTrace()
+        self.capturedRuns.connect(self.trace.add_runs)
+
+        layout = QtGui.QGridLayout()
+        layout.addWidget(QtGui.QLabel("Sample rate"), 0, 0)
+        layout.addWidget(self.rate, 0, 1)
+        layout.addWidget(QtGui.QLabel("Window"), 0, 2)
+        layout.addWidget(self.span, 0, 3)
+        layout.addWidget(self.start_stop, 0, 4)
+        layout.addWidget(self.trace, 1, 0, 1, 5)
+        self.setLayout(layout)
+
+        self.show()
+
+    def change_span(self, index):
+        self.trace.span = self.spans[index]
+        self.trace.update()
+
+    def toggle(self):
+        if self.board is None:
+            self.start()
+        else:
+            self.stop()
+
+    def start(self):
+        port = ser_con.find_port(self.master_app)
+        if port is None:
+            return
+
+        rate = RATES[self.rate.currentIndex()]
+        self.trace.clear(rate)
+        self.board = ser_con.BoardClient(port)
+        try:
+            self.board.capture(rate, self.capturedRuns.emit).result(
+                    ser_con.TIMEOUT)
+        except Exception as e:
+            QtGui.QMessageBox.warning(self, "Logic Analyser",
+                                      "Capture failed: " + str(e))
+            self.board.close()
+            self.board = None
+            return
+        self.start_stop.setText("Stop")
+
+    def stop(self):
+        try:
+            self.board.capture(0).result(ser_con.TIMEOUT)
+        except Exception:
+            pass
+        self.board.close()
+        self.board = None
+        self.start_stop.setText("Start")
@@ -66,6 +66,9 @@ class DragDropEditor(QtGui.QWidget):
         self.filePath = path
         self.isSaved = saved
         self.libs = []
+        # The timed tasks, {number: (period in ms, priority)}; task 0 is the
+        # background scan and is not listed
+        self.tasks = {}
 
         self.currentlyDrawing = False
         self.start_wid = None
@@ -26,6 +26,8 @@ class tile(QtGui.QPushButton):
         self.func_dict = {}
         self.func_dict['FunctionReference'] = "0x0000"
         self.set_value = "None"
+        # The task the tile runs in, 0 for the background scan
+        self.task = 0
         self.arrows = []
 
         super(tile, self).__init__(parent)
@@ -154,13 +156,31 @@ class tile(QtGui.QPushButton):
             if option['FunctionName'] == function_name[0] and function_name[1] == True:
                 self.func_dict = option
                 self.setToolTip(self.func_dict['ToolTip'])
-                self.setText(self.func_dict['FunctionName'])
-                try:
-                    if self.func_dict['Input1'][-3:] == "set":
-                        set_value = QtGui.QInputDialog.getText(self.parent, "Set Value", "Input set value")
-                        self.set_value = set_value[0]
-                except KeyError:
-                    break
+                self.set_task(self.task)
+                # Ask for each set input's value, typed as its kind says
+                # (set and set32 in hex, setiq and setf in decimal)
+                set_values = []
+                i = 1
+                while 'Input' + str(i) in self.func_dict:
+                    name, kind = self.func_dict['Input' + str(i)].split(' ')[1:3]
+                    if kind.startswith("set"):
+                        set_value = QtGui.QInputDialog.getText(self.parent, "Set Value", "Set value of " + name + " (" + kind + ")")
+                        set_values.append(set_value[0].replace(' ', ''))
+                    i += 1
+                if set_values:
+                    self.set_value = ",".join(set_values)
+
+    def set_task(self, task):
+        """ Moves the tile to a task and labels it with the task number
+            Parameters
+                task: The task number, 0 for the background scan
+        """
+
+        self.task = task
+        text = self.func_dict.get('FunctionName', '')
+        if task:
+            text += "\nTask " + str(task)
+        self.setText(text)
 
     def delete_tile(self):
         modifier = QtGui.QApplication.keyboardModifiers()
@@ -68,6 +68,9 @@ class Workspace(QtGui.QTabWidget):
                         line = line.strip("\n")
                         path = line.split(" ")
                         self.add_library(path[1])
+                    elif line[0] == 'T':
+                        params = line.split()
+                        added_file.tasks[int(params[1])] = (int(params[2]), int(params[3]))
                     elif line[0] == "#":
                         added_file.numOfChildren += 1
                         line = line.strip("\n")
@@ -81,6 +84,8 @@ class Workspace(QtGui.QTabWidget):
                                     new_tile.setToolTip(v['ToolTip'])
                                     new_tile.setText(v['FunctionName'])
                             new_tile.set_value = params[5]
+                            if len(params) > 6:
+                                new_tile.set_task(int(params[6]))
                         new_tile.drawConnection.connect(added_file.drawArrow)
                         new_tile.fileChange.connect(lambda: self.save_state_change(False))
                     elif line[0] == ">":
@@ -155,6 +160,9 @@ class Workspace(QtGui.QTabWidget):
                 new_dict['Output' + str(num)] = input_text
                 num += 1
                 input_text = f.readline().strip('\n')
+            # State lines only size the tile's storage on the board
+            while input_text[0] == 's':
+                input_text = f.readline().strip('\n')
             new_dict['ToolTip'] = input_text
             new_dict['IconPath'] = f.readline().strip('\n')
             for i in range(self.count()):